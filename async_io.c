@@ -0,0 +1,415 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "async_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define CANCEL_USER_DATA UINT64_MAX
+
+typedef struct Device
+{
+  int fd;
+  size_t bufferSize;
+  uint8_t* readBuffer;                    // Target of posted read request
+  uint8_t* receivedBuffer;                // Data received and not yet taken
+  size_t receivedSize;
+  uint8_t* writeBuffer;                   // Data of posted write request
+  size_t writeSize, writtenSize;
+  uint8_t* queuedBuffer;                  // Data to be written on next processing
+  size_t queuedSize;
+  bool isReadPending, isWritePending;
+}
+Device;
+
+typedef struct SubmissionQueue
+{
+  _Atomic unsigned* head;
+  _Atomic unsigned* tail;
+  unsigned* mask;
+  unsigned* entriesNumber;
+  unsigned* array;
+  struct io_uring_sqe* entriesList;
+}
+SubmissionQueue;
+
+typedef struct CompletionQueue
+{
+  _Atomic unsigned* head;
+  _Atomic unsigned* tail;
+  unsigned* mask;
+  struct io_uring_cqe* entriesList;
+}
+CompletionQueue;
+
+struct _AsyncIOData
+{
+  Device* devicesList;
+  size_t devicesNumber, maxDevicesNumber;
+  struct pollfd* pollList;
+  int ringFD;
+  void* sqRing;
+  size_t sqRingSize;
+  void* cqRing;
+  size_t cqRingSize;
+  size_t sqesSize;
+  SubmissionQueue submissions;
+  CompletionQueue completions;
+  unsigned submissionsNumber;
+};
+
+
+static bool InitIOUring( AsyncIO io )
+{
+  struct io_uring_params parameters = { 0 };
+  io->ringFD = (int) syscall( __NR_io_uring_setup, (unsigned) ( 2 * io->maxDevicesNumber ), &parameters );
+  if( io->ringFD < 0 ) return false;
+  
+  // Fast poll (Linux 5.7) is required for efficient socket/pty reads, and implies read/write operations support (Linux 5.6)
+  if( !( parameters.features & IORING_FEAT_FAST_POLL ) ) return false;
+  
+  io->sqRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+  io->cqRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe);
+  if( parameters.features & IORING_FEAT_SINGLE_MMAP )
+  {
+    if( io->cqRingSize > io->sqRingSize ) io->sqRingSize = io->cqRingSize;
+    io->cqRingSize = 0;
+  }
+  
+  io->sqRing = mmap( NULL, io->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ringFD, IORING_OFF_SQ_RING );
+  if( io->sqRing == MAP_FAILED ) return false;
+  io->cqRing = io->sqRing;
+  if( io->cqRingSize > 0 )
+  {
+    io->cqRing = mmap( NULL, io->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ringFD, IORING_OFF_CQ_RING );
+    if( io->cqRing == MAP_FAILED ) return false;
+  }
+  
+  io->sqesSize = parameters.sq_entries * sizeof(struct io_uring_sqe);
+  io->submissions.entriesList = mmap( NULL, io->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ringFD, IORING_OFF_SQES );
+  if( io->submissions.entriesList == MAP_FAILED ) return false;
+  
+  uint8_t* sqRing = (uint8_t*) io->sqRing;
+  io->submissions.head = (_Atomic unsigned*) ( sqRing + parameters.sq_off.head );
+  io->submissions.tail = (_Atomic unsigned*) ( sqRing + parameters.sq_off.tail );
+  io->submissions.mask = (unsigned*) ( sqRing + parameters.sq_off.ring_mask );
+  io->submissions.entriesNumber = (unsigned*) ( sqRing + parameters.sq_off.ring_entries );
+  io->submissions.array = (unsigned*) ( sqRing + parameters.sq_off.array );
+  
+  uint8_t* cqRing = (uint8_t*) io->cqRing;
+  io->completions.head = (_Atomic unsigned*) ( cqRing + parameters.cq_off.head );
+  io->completions.tail = (_Atomic unsigned*) ( cqRing + parameters.cq_off.tail );
+  io->completions.mask = (unsigned*) ( cqRing + parameters.cq_off.ring_mask );
+  io->completions.entriesList = (struct io_uring_cqe*) ( cqRing + parameters.cq_off.cqes );
+  
+  return true;
+}
+
+static void EndIOUring( AsyncIO io )
+{
+  if( io->submissions.entriesList != NULL && io->submissions.entriesList != MAP_FAILED ) munmap( io->submissions.entriesList, io->sqesSize );
+  if( io->cqRing != NULL && io->cqRing != MAP_FAILED && io->cqRing != io->sqRing ) munmap( io->cqRing, io->cqRingSize );
+  if( io->sqRing != NULL && io->sqRing != MAP_FAILED ) munmap( io->sqRing, io->sqRingSize );
+  if( io->ringFD >= 0 ) close( io->ringFD );
+  io->submissions.entriesList = io->cqRing = io->sqRing = NULL;
+  io->ringFD = -1;
+}
+
+static bool QueueSubmission( AsyncIO io, uint8_t operation, int fd, uint64_t address, unsigned length, uint64_t userData )
+{
+  SubmissionQueue* queue = &(io->submissions);
+  unsigned tail = atomic_load_explicit( queue->tail, memory_order_relaxed );
+  if( tail - atomic_load_explicit( queue->head, memory_order_acquire ) >= *(queue->entriesNumber) ) return false;
+  
+  unsigned index = tail & *(queue->mask);
+  struct io_uring_sqe* entry = &(queue->entriesList[ index ]);
+  memset( entry, 0, sizeof(struct io_uring_sqe) );
+  entry->opcode = operation;
+  entry->fd = fd;
+  if( operation != IORING_OP_ASYNC_CANCEL ) entry->off = (uint64_t) -1;   // Current file position, as non seekable devices require
+  entry->addr = address;
+  entry->len = length;
+  entry->user_data = userData;
+  queue->array[ index ] = index;
+  
+  atomic_store_explicit( queue->tail, tail + 1, memory_order_release );
+  io->submissionsNumber++;
+  
+  return true;
+}
+
+static void EnterIOUring( AsyncIO io, unsigned minCompletions )
+{
+  syscall( __NR_io_uring_enter, io->ringFD, io->submissionsNumber, minCompletions, IORING_ENTER_GETEVENTS, NULL, 0 );
+  io->submissionsNumber = 0;
+}
+
+static void ReceiveData( Device* device, const uint8_t* data, size_t dataSize )
+{
+  // Data not fitting the received buffer (not taken in time) is dropped
+  size_t freeSize = device->bufferSize - device->receivedSize;
+  if( dataSize > freeSize ) dataSize = freeSize;
+  memcpy( device->receivedBuffer + device->receivedSize, data, dataSize );
+  device->receivedSize += dataSize;
+}
+
+static void CompleteWrite( Device* device, ssize_t result )
+{
+  if( result > 0 ) device->writtenSize += (size_t) result;
+  // Failed writes are dropped, partial ones resumed on next processing
+  if( result <= 0 || device->writtenSize >= device->writeSize ) device->writeSize = device->writtenSize = 0;
+}
+
+static bool StartWrite( Device* device )
+{
+  if( device->writtenSize < device->writeSize ) return true;
+  if( device->queuedSize == 0 ) return false;
+  
+  uint8_t* writeBuffer = device->writeBuffer;
+  device->writeBuffer = device->queuedBuffer;
+  device->writeSize = device->queuedSize;
+  device->writtenSize = 0;
+  device->queuedBuffer = writeBuffer;
+  device->queuedSize = 0;
+  
+  return true;
+}
+
+static void ReapCompletions( AsyncIO io )
+{
+  CompletionQueue* queue = &(io->completions);
+  unsigned head = atomic_load_explicit( queue->head, memory_order_relaxed );
+  unsigned tail = atomic_load_explicit( queue->tail, memory_order_acquire );
+  
+  for( ; head != tail; head++ )
+  {
+    struct io_uring_cqe* entry = &(queue->entriesList[ head & *(queue->mask) ]);
+    if( entry->user_data == CANCEL_USER_DATA ) continue;
+    
+    Device* device = &(io->devicesList[ entry->user_data >> 1 ]);
+    if( entry->user_data & 1 )
+    {
+      device->isWritePending = false;
+      CompleteWrite( device, entry->res );
+    }
+    else
+    {
+      device->isReadPending = false;
+      if( entry->res > 0 ) ReceiveData( device, device->readBuffer, (size_t) entry->res );
+    }
+  }
+  
+  atomic_store_explicit( queue->head, head, memory_order_release );
+}
+
+static void ProcessIOUring( AsyncIO io )
+{
+  for( size_t deviceIndex = 0; deviceIndex < io->devicesNumber; deviceIndex++ )
+  {
+    Device* device = &(io->devicesList[ deviceIndex ]);
+    uint64_t userData = (uint64_t) deviceIndex << 1;
+    if( !device->isReadPending )
+      device->isReadPending = QueueSubmission( io, IORING_OP_READ, device->fd, (uint64_t) (uintptr_t) device->readBuffer, (unsigned) device->bufferSize, userData );
+    if( !device->isWritePending && StartWrite( device ) )
+    {
+      device->isWritePending = QueueSubmission( io, IORING_OP_WRITE, device->fd, (uint64_t) (uintptr_t) ( device->writeBuffer + device->writtenSize ), 
+                                                (unsigned) ( device->writeSize - device->writtenSize ), userData | 1 );
+    }
+  }
+  
+  // Single system call per processing, submitting all requests and flushing completions
+  EnterIOUring( io, 0 );
+  
+  ReapCompletions( io );
+}
+
+static void ProcessPoll( AsyncIO io )
+{
+  for( size_t deviceIndex = 0; deviceIndex < io->devicesNumber; deviceIndex++ )
+  {
+    Device* device = &(io->devicesList[ deviceIndex ]);
+    io->pollList[ deviceIndex ].events = 0;
+    if( device->receivedSize < device->bufferSize ) io->pollList[ deviceIndex ].events |= POLLIN;
+    if( StartWrite( device ) ) io->pollList[ deviceIndex ].events |= POLLOUT;
+    io->pollList[ deviceIndex ].revents = 0;
+  }
+  
+  if( poll( io->pollList, io->devicesNumber, 0 ) <= 0 ) return;
+  
+  for( size_t deviceIndex = 0; deviceIndex < io->devicesNumber; deviceIndex++ )
+  {
+    Device* device = &(io->devicesList[ deviceIndex ]);
+    if( io->pollList[ deviceIndex ].revents & POLLIN )
+    {
+      ssize_t result = read( device->fd, device->receivedBuffer + device->receivedSize, device->bufferSize - device->receivedSize );
+      if( result > 0 ) device->receivedSize += (size_t) result;
+    }
+    if( io->pollList[ deviceIndex ].revents & POLLOUT )
+    {
+      ssize_t result = write( device->fd, device->writeBuffer + device->writtenSize, device->writeSize - device->writtenSize );
+      if( result < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) continue;
+      CompleteWrite( device, result );
+    }
+  }
+}
+
+AsyncIO AsyncIO_Create( size_t maxDevicesNumber, enum AsyncIOBackend backend )
+{
+  if( maxDevicesNumber == 0 ) return NULL;
+  
+  AsyncIO newIO = (AsyncIO) calloc( 1, sizeof(AsyncIOData) );
+  if( newIO == NULL ) return NULL;
+  
+  newIO->maxDevicesNumber = maxDevicesNumber;
+  newIO->devicesList = (Device*) calloc( maxDevicesNumber, sizeof(Device) );
+  newIO->pollList = (struct pollfd*) calloc( maxDevicesNumber, sizeof(struct pollfd) );
+  newIO->ringFD = -1;
+  if( newIO->devicesList == NULL || newIO->pollList == NULL )
+  {
+    AsyncIO_Discard( newIO );
+    return NULL;
+  }
+  
+  if( backend == ASYNC_IO_AUTO && !InitIOUring( newIO ) ) EndIOUring( newIO );
+  
+  return newIO;
+}
+
+void AsyncIO_Discard( AsyncIO io )
+{
+  if( io == NULL ) return;
+  
+  if( io->ringFD >= 0 )
+  {
+    // Buffers can only be released after the kernel is done with all requests referencing them
+    ReapCompletions( io );
+    for( size_t deviceIndex = 0; deviceIndex < io->devicesNumber; deviceIndex++ )
+    {
+      uint64_t userData = (uint64_t) deviceIndex << 1;
+      if( io->devicesList[ deviceIndex ].isReadPending ) QueueSubmission( io, IORING_OP_ASYNC_CANCEL, -1, userData, 0, CANCEL_USER_DATA );
+      if( io->devicesList[ deviceIndex ].isWritePending ) QueueSubmission( io, IORING_OP_ASYNC_CANCEL, -1, userData | 1, 0, CANCEL_USER_DATA );
+    }
+    while( true )
+    {
+      bool hasPendingRequests = false;
+      for( size_t deviceIndex = 0; deviceIndex < io->devicesNumber; deviceIndex++ )
+        hasPendingRequests = hasPendingRequests || io->devicesList[ deviceIndex ].isReadPending || io->devicesList[ deviceIndex ].isWritePending;
+      if( !hasPendingRequests ) break;
+      EnterIOUring( io, 1 );
+      ReapCompletions( io );
+    }
+    EndIOUring( io );
+  }
+  
+  for( size_t deviceIndex = 0; deviceIndex < io->devicesNumber; deviceIndex++ )
+  {
+    free( io->devicesList[ deviceIndex ].readBuffer );
+    free( io->devicesList[ deviceIndex ].receivedBuffer );
+    free( io->devicesList[ deviceIndex ].writeBuffer );
+    free( io->devicesList[ deviceIndex ].queuedBuffer );
+  }
+  free( io->devicesList );
+  free( io->pollList );
+  
+  free( io );
+}
+
+bool AsyncIO_IsUsingIOUring( AsyncIO io )
+{
+  return ( io->ringFD >= 0 );
+}
+
+int AsyncIO_AddDevice( AsyncIO io, int fd, size_t bufferSize )
+{
+  if( fd < 0 || bufferSize == 0 ) return -1;
+  if( io->devicesNumber >= io->maxDevicesNumber ) return -1;
+  
+  Device* device = &(io->devicesList[ io->devicesNumber ]);
+  device->fd = fd;
+  device->bufferSize = bufferSize;
+  device->readBuffer = (uint8_t*) malloc( bufferSize );
+  device->receivedBuffer = (uint8_t*) malloc( bufferSize );
+  device->writeBuffer = (uint8_t*) malloc( bufferSize );
+  device->queuedBuffer = (uint8_t*) malloc( bufferSize );
+  if( device->readBuffer == NULL || device->receivedBuffer == NULL || device->writeBuffer == NULL || device->queuedBuffer == NULL )
+  {
+    free( device->readBuffer );
+    free( device->receivedBuffer );
+    free( device->writeBuffer );
+    free( device->queuedBuffer );
+    memset( device, 0, sizeof(Device) );
+    return -1;
+  }
+  
+  if( io->ringFD < 0 )
+  {
+    fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+    io->pollList[ io->devicesNumber ].fd = fd;
+  }
+  
+  return (int) io->devicesNumber++;
+}
+
+bool AsyncIO_Write( AsyncIO io, int deviceIndex, const void* data, size_t dataSize )
+{
+  if( deviceIndex < 0 || (size_t) deviceIndex >= io->devicesNumber ) return false;
+  
+  Device* device = &(io->devicesList[ deviceIndex ]);
+  if( device->queuedSize + dataSize > device->bufferSize ) return false;
+  
+  memcpy( device->queuedBuffer + device->queuedSize, data, dataSize );
+  device->queuedSize += dataSize;
+  
+  return true;
+}
+
+void AsyncIO_Process( AsyncIO io )
+{
+  if( io->devicesNumber == 0 ) return;
+  
+  if( io->ringFD >= 0 ) ProcessIOUring( io );
+  else ProcessPoll( io );
+}
+
+size_t AsyncIO_Read( AsyncIO io, int deviceIndex, void* data, size_t maxDataSize )
+{
+  if( deviceIndex < 0 || (size_t) deviceIndex >= io->devicesNumber ) return 0;
+  
+  Device* device = &(io->devicesList[ deviceIndex ]);
+  size_t dataSize = ( device->receivedSize < maxDataSize ) ? device->receivedSize : maxDataSize;
+  memcpy( data, device->receivedBuffer, dataSize );
+  device->receivedSize -= dataSize;
+  memmove( device->receivedBuffer, device->receivedBuffer + dataSize, device->receivedSize );
+  
+  return dataSize;
+}
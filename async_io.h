@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file async_io.h
+/// @brief Asynchronous device I/O helper for plugins talking to serial, socket or other file descriptor attached drives
+///
+/// Reads are kept posted on every registered device and writes are queued, so that a single non-blocking AsyncIO_Process call per control
+/// step submits all pending writes at once and collects all received data. Uses Linux io_uring when available, falling back to poll() otherwise.
+/// All functions of the same AsyncIO instance should be called from a single (usually the control) thread
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Asynchronous I/O backends enumeration
+enum AsyncIOBackend 
+{ 
+  ASYNC_IO_AUTO,            ///< Use io_uring if supported by the running kernel, poll otherwise
+  ASYNC_IO_POLL             ///< Always use poll (e.g. for comparison or restricted environments)
+};
+
+/// Opaque asynchronous I/O data
+typedef struct _AsyncIOData AsyncIOData;
+/// Opaque reference to asynchronous I/O instance
+typedef AsyncIOData* AsyncIO;
+
+/// @brief Creates asynchronous I/O instance
+/// @param[in] maxDevicesNumber maximum number of devices to be added
+/// @param[in] backend preferred I/O backend
+/// @return reference to created instance on success, NULL otherwise
+AsyncIO AsyncIO_Create( size_t maxDevicesNumber, enum AsyncIOBackend backend );
+
+/// @brief Cancels pending requests and deallocates data of given asynchronous I/O instance (added file descriptors are not closed)
+/// @param[in] io reference to asynchronous I/O instance
+void AsyncIO_Discard( AsyncIO io );
+
+/// @brief Checks if asynchronous I/O instance uses io_uring backend
+/// @param[in] io reference to asynchronous I/O instance
+/// @return true for io_uring backend, false for poll fallback
+bool AsyncIO_IsUsingIOUring( AsyncIO io );
+
+/// @brief Registers device file descriptor for asynchronous reads and writes. The poll backend sets it as non-blocking
+/// @param[in] io reference to asynchronous I/O instance
+/// @param[in] fd open file descriptor (serial port, pty, socket, pipe, etc.)
+/// @param[in] bufferSize maximum number of bytes kept for each of received and queued write data
+/// @return index of added device on success, -1 otherwise
+int AsyncIO_AddDevice( AsyncIO io, int fd, size_t bufferSize );
+
+/// @brief Queues data to be written to device on next processing
+/// @param[in] io reference to asynchronous I/O instance
+/// @param[in] deviceIndex index of device returned by AsyncIO_AddDevice
+/// @param[in] data reference/pointer to data to be written
+/// @param[in] dataSize number of bytes to be written
+/// @return true on success, false for invalid device or not enough space in write queue
+bool AsyncIO_Write( AsyncIO io, int deviceIndex, const void* data, size_t dataSize );
+
+/// @brief Submits queued writes and pending reads of all devices and collects completed ones, without blocking
+/// @param[in] io reference to asynchronous I/O instance
+void AsyncIO_Process( AsyncIO io );
+
+/// @brief Takes data received from device up to the last processing
+/// @param[in] io reference to asynchronous I/O instance
+/// @param[in] deviceIndex index of device returned by AsyncIO_AddDevice
+/// @param[out] data reference/pointer to buffer where received data will be copied
+/// @param[in] maxDataSize maximum number of bytes to be copied
+/// @return number of bytes copied (0 if nothing was received or for invalid device)
+size_t AsyncIO_Read( AsyncIO io, int deviceIndex, void* data, size_t maxDataSize );
+
+#endif  // ASYNC_IO_H
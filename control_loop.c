@@ -0,0 +1,411 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "control_loop.h"
+#include "rt_guard.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NSECS_PER_SEC 1000000000LL
+
+// Real-time safety guard functions are only defined when the RobotControlGuard debug library is linked or preloaded
+#pragma weak RTGuard_PrepareThread
+#pragma weak RTGuard_EnterStep
+#pragma weak RTGuard_ExitStep
+
+static inline void PrepareGuardedThread( void )
+{
+  if( RTGuard_PrepareThread != NULL ) RTGuard_PrepareThread( 0 );
+}
+
+static inline void EnterGuardedStep( void )
+{
+  if( RTGuard_EnterStep != NULL ) RTGuard_EnterStep();
+}
+
+static inline void ExitGuardedStep( void )
+{
+  if( RTGuard_ExitStep != NULL ) RTGuard_ExitStep();
+}
+
+struct _ControlLoopData
+{
+  ControlLoopSettings settings;
+  ControlStepFunction runStep;
+  ControlStepFunction runSlowStep;
+  uint64_t slowStepDivider;
+  ControlPhaseFunction runIOPhase;
+  ControlPhaseFunction runComputePhase;
+  void* stepData;
+  pthread_t thread, ioThread;
+  bool hasThread, hasIOThread;
+  sem_t ioStartSignal, ioEndSignal;
+  sem_t placementSignal;
+  atomic_bool isPlacementFailed;
+  size_t ioBufferIndex;
+  double ioTimeDelta;
+  atomic_bool isRunning;
+  atomic_bool isIORunning;                // Only cleared after loop thread ends, so that started I/O phases always signal their end
+  atomic_uint_fast64_t stepsCount, slowStepsCount;
+  _Atomic double lastTimeDelta, lastWakeupLatency, maxWakeupLatency;
+  _Atomic double lastStepDuration, maxStepDuration;
+  atomic_uint_fast64_t deadlineMissesCount, consecutiveDeadlineMisses, degradationsCount;
+  atomic_int threadID, cpu;
+  atomic_uint_fast64_t migrationsCount;
+};
+
+
+static inline int64_t GetTimeNs( const struct timespec* time )
+{
+  return (int64_t) time->tv_sec * NSECS_PER_SEC + time->tv_nsec;
+}
+
+static inline struct timespec GetTimespec( int64_t timeNs )
+{
+  struct timespec time = { .tv_sec = timeNs / NSECS_PER_SEC, .tv_nsec = timeNs % NSECS_PER_SEC };
+  return time;
+}
+
+// Reports placement result of a new loop thread, which shouldn't run steps with failed placement
+static bool ApplyPlacement( ControlLoop loop )
+{
+  bool isPlaced = ( loop->settings.placement == NULL || ControlPlacement_ApplyToThread( loop->settings.placement ) );
+  if( !isPlaced ) atomic_store( &(loop->isPlacementFailed), true );
+  sem_post( &(loop->placementSignal) );
+  
+  return isPlaced;
+}
+
+static void* RunIOPhases( void* data )
+{
+  ControlLoop loop = (ControlLoop) data;
+  
+  if( !ApplyPlacement( loop ) ) return NULL;
+  PrepareGuardedThread();
+  
+  while( true )
+  {
+    while( sem_wait( &(loop->ioStartSignal) ) == -1 && errno == EINTR );
+    if( !atomic_load_explicit( &(loop->isIORunning), memory_order_relaxed ) ) break;
+    
+    EnterGuardedStep();
+    loop->runIOPhase( loop->stepData, loop->ioBufferIndex, loop->ioTimeDelta );
+    ExitGuardedStep();
+    
+    sem_post( &(loop->ioEndSignal) );
+  }
+  
+  return NULL;
+}
+
+// I/O phase of this cycle runs on its own thread, with the buffer set filled by the last compute phase, 
+// while the compute phase processes the set written and read by the last I/O phase
+static void RunPipelinedCycle( ControlLoop loop, double timeDelta )
+{
+  loop->ioBufferIndex = 1 - loop->ioBufferIndex;
+  loop->ioTimeDelta = timeDelta;
+  sem_post( &(loop->ioStartSignal) );
+  
+  EnterGuardedStep();
+  loop->runComputePhase( loop->stepData, 1 - loop->ioBufferIndex, timeDelta );
+  ExitGuardedStep();
+  
+  while( sem_wait( &(loop->ioEndSignal) ) == -1 && errno == EINTR );
+}
+
+static void* RunLoop( void* data )
+{
+  ControlLoop loop = (ControlLoop) data;
+  
+  int64_t periodNs = (int64_t) ( loop->settings.stepPeriod * NSECS_PER_SEC );
+  
+  if( !ApplyPlacement( loop ) ) return NULL;
+  PrepareGuardedThread();
+  atomic_store_explicit( &(loop->threadID), ControlPlacement_GetThreadID(), memory_order_relaxed );
+  
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  int64_t deadlineNs = GetTimeNs( &now );
+  int64_t lastStepTimeNs = deadlineNs;
+  int64_t lastSlowStepTimeNs = deadlineNs;
+  uint64_t cyclesCount = 0;
+  uint64_t consecutiveDeadlineMisses = 0;
+  
+  while( atomic_load_explicit( &(loop->isRunning), memory_order_relaxed ) )
+  {
+    deadlineNs += periodNs;
+    struct timespec deadline = GetTimespec( deadlineNs );
+    while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL ) == EINTR );
+    
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    int64_t stepTimeNs = GetTimeNs( &now );
+    double wakeupLatency = (double) ( stepTimeNs - deadlineNs ) / NSECS_PER_SEC;
+    double timeDelta = (double) ( stepTimeNs - lastStepTimeNs ) / NSECS_PER_SEC;
+    lastStepTimeNs = stepTimeNs;
+    
+    int cpu = sched_getcpu();
+    int lastCPU = atomic_load_explicit( &(loop->cpu), memory_order_relaxed );
+    if( cpu != lastCPU )
+    {
+      if( lastCPU >= 0 ) atomic_fetch_add_explicit( &(loop->migrationsCount), 1, memory_order_relaxed );
+      atomic_store_explicit( &(loop->cpu), cpu, memory_order_relaxed );
+    }
+    
+    if( loop->runSlowStep != NULL && ++cyclesCount % loop->slowStepDivider == 0 )
+    {
+      EnterGuardedStep();
+      loop->runSlowStep( loop->stepData, (double) ( stepTimeNs - lastSlowStepTimeNs ) / NSECS_PER_SEC );
+      ExitGuardedStep();
+      lastSlowStepTimeNs = stepTimeNs;
+      atomic_fetch_add_explicit( &(loop->slowStepsCount), 1, memory_order_relaxed );
+    }
+    
+    if( loop->runIOPhase != NULL ) RunPipelinedCycle( loop, timeDelta );
+    else
+    {
+      EnterGuardedStep();
+      loop->runStep( loop->stepData, timeDelta );
+      ExitGuardedStep();
+    }
+    
+    atomic_store_explicit( &(loop->lastTimeDelta), timeDelta, memory_order_relaxed );
+    atomic_store_explicit( &(loop->lastWakeupLatency), wakeupLatency, memory_order_relaxed );
+    if( wakeupLatency > atomic_load_explicit( &(loop->maxWakeupLatency), memory_order_relaxed ) )
+      atomic_store_explicit( &(loop->maxWakeupLatency), wakeupLatency, memory_order_relaxed );
+    atomic_fetch_add_explicit( &(loop->stepsCount), 1, memory_order_release );
+    
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    int64_t stepEndTimeNs = GetTimeNs( &now );
+    double stepDuration = (double) ( stepEndTimeNs - stepTimeNs ) / NSECS_PER_SEC;
+    atomic_store_explicit( &(loop->lastStepDuration), stepDuration, memory_order_relaxed );
+    if( stepDuration > atomic_load_explicit( &(loop->maxStepDuration), memory_order_relaxed ) )
+      atomic_store_explicit( &(loop->maxStepDuration), stepDuration, memory_order_relaxed );
+    
+    // Steps ending after the next deadline miss it. Following deadlines are realigned instead of running late steps back-to-back
+    if( stepEndTimeNs > deadlineNs + periodNs )
+    {
+      atomic_fetch_add_explicit( &(loop->deadlineMissesCount), 1, memory_order_relaxed );
+      if( ++consecutiveDeadlineMisses == loop->settings.maxDeadlineMisses && loop->settings.setControlState != NULL )
+      {
+        loop->settings.setControlState( CONTROL_PASSIVE );
+        atomic_fetch_add_explicit( &(loop->degradationsCount), 1, memory_order_relaxed );
+      }
+      deadlineNs = stepEndTimeNs;
+    }
+    else consecutiveDeadlineMisses = 0;
+    atomic_store_explicit( &(loop->consecutiveDeadlineMisses), consecutiveDeadlineMisses, memory_order_relaxed );
+  }
+  
+  return NULL;
+}
+
+static bool StartThread( pthread_t* thread, int priority, void* (*runThread)( void* ), void* data )
+{
+  pthread_attr_t threadAttributes;
+  pthread_attr_init( &threadAttributes );
+  if( priority > 0 )
+  {
+    struct sched_param schedulingParameters = { .sched_priority = priority };
+    pthread_attr_setinheritsched( &threadAttributes, PTHREAD_EXPLICIT_SCHED );
+    pthread_attr_setschedpolicy( &threadAttributes, SCHED_FIFO );
+    pthread_attr_setschedparam( &threadAttributes, &schedulingParameters );
+  }
+  
+  int result = pthread_create( thread, &threadAttributes, runThread, data );
+  pthread_attr_destroy( &threadAttributes );
+  
+  return ( result == 0 );
+}
+
+static inline void WaitPlacement( ControlLoop loop )
+{
+  while( sem_wait( &(loop->placementSignal) ) == -1 && errno == EINTR );
+}
+
+// Gets number of steps per slow step, or 0 for invalid periods (including non-positive, infinite or NaN ones)
+static uint64_t GetSlowStepDivider( const ControlLoopSettings* settings )
+{
+  if( !( settings->stepPeriod > 0.0 ) ) return 0;
+  
+  double slowStepRatio = settings->slowStepPeriod / settings->stepPeriod;
+  if( !( slowStepRatio >= 1.0 && slowStepRatio < (double) UINT64_MAX ) ) return 0;
+  
+  return (uint64_t) ( slowStepRatio + 0.5 );
+}
+
+static ControlLoop StartLoop( const ControlLoopSettings* settings, ControlStepFunction runStep, ControlStepFunction runSlowStep, 
+                              ControlPhaseFunction runIOPhase, ControlPhaseFunction runComputePhase, void* stepData )
+{
+  if( settings == NULL ) return NULL;
+  if( settings->stepPeriod <= 0.0 || settings->priority < 0 ) return NULL;
+  if( runSlowStep != NULL && GetSlowStepDivider( settings ) == 0 ) return NULL;
+  if( settings->placement != NULL && ( ControlPlacement_Validate( settings->placement ) & PLACEMENT_ERRORS ) ) return NULL;
+  
+  ControlLoop newLoop = (ControlLoop) calloc( 1, sizeof(ControlLoopData) );
+  if( newLoop == NULL ) return NULL;
+  
+  newLoop->settings = *settings;
+  newLoop->runStep = runStep;
+  newLoop->runSlowStep = runSlowStep;
+  newLoop->runIOPhase = runIOPhase;
+  newLoop->runComputePhase = runComputePhase;
+  newLoop->slowStepDivider = ( runSlowStep != NULL ) ? GetSlowStepDivider( settings ) : 1;
+  newLoop->stepData = stepData;
+  atomic_init( &(newLoop->isRunning), true );
+  atomic_init( &(newLoop->isIORunning), true );
+  atomic_init( &(newLoop->isPlacementFailed), false );
+  atomic_init( &(newLoop->stepsCount), 0 );
+  atomic_init( &(newLoop->slowStepsCount), 0 );
+  atomic_init( &(newLoop->lastTimeDelta), 0.0 );
+  atomic_init( &(newLoop->lastWakeupLatency), 0.0 );
+  atomic_init( &(newLoop->maxWakeupLatency), 0.0 );
+  atomic_init( &(newLoop->lastStepDuration), 0.0 );
+  atomic_init( &(newLoop->maxStepDuration), 0.0 );
+  atomic_init( &(newLoop->deadlineMissesCount), 0 );
+  atomic_init( &(newLoop->consecutiveDeadlineMisses), 0 );
+  atomic_init( &(newLoop->degradationsCount), 0 );
+  atomic_init( &(newLoop->threadID), 0 );
+  atomic_init( &(newLoop->cpu), -1 );
+  atomic_init( &(newLoop->migrationsCount), 0 );
+  
+  sem_init( &(newLoop->ioStartSignal), 0, 0 );
+  sem_init( &(newLoop->ioEndSignal), 0, 0 );
+  sem_init( &(newLoop->placementSignal), 0, 0 );
+  
+  // Each thread is only started after the previous one is placed, and loop start fails if any placement fails
+  if( runIOPhase != NULL )
+  {
+    newLoop->hasIOThread = StartThread( &(newLoop->ioThread), settings->priority, RunIOPhases, newLoop );
+    if( newLoop->hasIOThread ) WaitPlacement( newLoop );
+  }
+  if( ( runIOPhase == NULL || newLoop->hasIOThread ) && !atomic_load( &(newLoop->isPlacementFailed) ) )
+  {
+    newLoop->hasThread = StartThread( &(newLoop->thread), settings->priority, RunLoop, newLoop );
+    if( newLoop->hasThread ) WaitPlacement( newLoop );
+  }
+  
+  if( !newLoop->hasThread || atomic_load( &(newLoop->isPlacementFailed) ) )
+  {
+    ControlLoop_Stop( newLoop );
+    return NULL;
+  }
+  
+  return newLoop;
+}
+
+ControlLoop ControlLoop_Start( const ControlLoopSettings* settings, ControlStepFunction runStep, void* stepData )
+{
+  if( runStep == NULL ) return NULL;
+  
+  return StartLoop( settings, runStep, NULL, NULL, NULL, stepData );
+}
+
+ControlLoop ControlLoop_StartMultiRate( const ControlLoopSettings* settings, ControlStepFunction runStep, ControlStepFunction runSlowStep, void* stepData )
+{
+  if( runStep == NULL ) return NULL;
+  
+  return StartLoop( settings, runStep, runSlowStep, NULL, NULL, stepData );
+}
+
+ControlLoop ControlLoop_StartPipelined( const ControlLoopSettings* settings, ControlPhaseFunction runIOPhase, ControlPhaseFunction runComputePhase, void* stepData )
+{
+  if( runIOPhase == NULL || runComputePhase == NULL ) return NULL;
+  
+  return StartLoop( settings, NULL, NULL, runIOPhase, runComputePhase, stepData );
+}
+
+uint64_t ControlLoop_RunVirtual( const ControlLoopSettings* settings, const double* timeDeltasList, size_t timeDeltasNumber, uint64_t stepsNumber, 
+                                 ControlStepFunction runStep, ControlStepFunction runSlowStep, void* stepData )
+{
+  if( settings == NULL || runStep == NULL ) return 0;
+  if( timeDeltasList == NULL && settings->stepPeriod <= 0.0 ) return 0;
+  if( timeDeltasList != NULL && timeDeltasNumber == 0 ) return 0;
+  // Slow steps are counted by stepPeriod, even when time deltas come from the list
+  uint64_t slowStepDivider = ( runSlowStep != NULL ) ? GetSlowStepDivider( settings ) : 1;
+  if( slowStepDivider == 0 ) return 0;
+  double slowTimeDelta = 0.0;
+  
+  for( uint64_t stepIndex = 0; stepIndex < stepsNumber; stepIndex++ )
+  {
+    double timeDelta = ( timeDeltasList != NULL ) ? timeDeltasList[ stepIndex % timeDeltasNumber ] : settings->stepPeriod;
+    
+    slowTimeDelta += timeDelta;
+    if( runSlowStep != NULL && ( stepIndex + 1 ) % slowStepDivider == 0 )
+    {
+      EnterGuardedStep();
+      runSlowStep( stepData, slowTimeDelta );
+      ExitGuardedStep();
+      slowTimeDelta = 0.0;
+    }
+    
+    EnterGuardedStep();
+    runStep( stepData, timeDelta );
+    ExitGuardedStep();
+  }
+  
+  return stepsNumber;
+}
+
+void ControlLoop_Stop( ControlLoop loop )
+{
+  if( loop == NULL ) return;
+  
+  atomic_store( &(loop->isRunning), false );
+  if( loop->hasThread ) pthread_join( loop->thread, NULL );
+  if( loop->hasIOThread )
+  {
+    atomic_store( &(loop->isIORunning), false );
+    sem_post( &(loop->ioStartSignal) );
+    pthread_join( loop->ioThread, NULL );
+  }
+  
+  sem_destroy( &(loop->ioStartSignal) );
+  sem_destroy( &(loop->ioEndSignal) );
+  sem_destroy( &(loop->placementSignal) );
+  
+  free( loop );
+}
+
+void ControlLoop_GetStatus( ControlLoop loop, ControlLoopStatus* status )
+{
+  status->stepsCount = atomic_load_explicit( &(loop->stepsCount), memory_order_acquire );
+  status->slowStepsCount = atomic_load_explicit( &(loop->slowStepsCount), memory_order_relaxed );
+  status->lastTimeDelta = atomic_load_explicit( &(loop->lastTimeDelta), memory_order_relaxed );
+  status->lastWakeupLatency = atomic_load_explicit( &(loop->lastWakeupLatency), memory_order_relaxed );
+  status->maxWakeupLatency = atomic_load_explicit( &(loop->maxWakeupLatency), memory_order_relaxed );
+  status->lastStepDuration = atomic_load_explicit( &(loop->lastStepDuration), memory_order_relaxed );
+  status->maxStepDuration = atomic_load_explicit( &(loop->maxStepDuration), memory_order_relaxed );
+  status->deadlineMissesCount = atomic_load_explicit( &(loop->deadlineMissesCount), memory_order_relaxed );
+  status->consecutiveDeadlineMisses = atomic_load_explicit( &(loop->consecutiveDeadlineMisses), memory_order_relaxed );
+  status->degradationsCount = atomic_load_explicit( &(loop->degradationsCount), memory_order_relaxed );
+  status->cpu = atomic_load_explicit( &(loop->cpu), memory_order_relaxed );
+  status->migrationsCount = atomic_load_explicit( &(loop->migrationsCount), memory_order_relaxed );
+  int threadID = atomic_load_explicit( &(loop->threadID), memory_order_relaxed );
+  status->involuntarySwitchesCount = ( threadID > 0 ) ? ControlPlacement_GetInvoluntarySwitchesCount( threadID ) : 0;
+}
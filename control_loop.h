@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file control_loop.h
+/// @brief Fixed period real-time loop executor for robot control steps
+///
+/// Runs a control step function (usually wrapping a plugin RunControlStep call) on a dedicated thread, waking it on absolute
+/// deadlines of the monotonic clock (no accumulated drift) and passing the measured time since the previous step as timeDelta.
+/// Cycles whose steps overrun the period are accounted as deadline misses, optionally switching the robot to passive control after too many of them.
+/// Steps may also be run over a virtual clock, for deterministic offline execution
+
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#include "robot_control.h"
+#include "control_placement.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Control step function called on each loop cycle
+/// @param[in] stepData reference to user data given on loop start
+/// @param[in] timeDelta measured time (in seconds) since the last step was called
+typedef void (*ControlStepFunction)( void* stepData, double timeDelta );
+
+/// Control phase function called on each pipelined loop cycle
+/// @param[in] stepData reference to user data given on loop start
+/// @param[in] bufferIndex index (0 or 1) of the double buffered data set to be used by the phase on this cycle
+/// @param[in] timeDelta measured time (in seconds) since the last cycle
+typedef void (*ControlPhaseFunction)( void* stepData, size_t bufferIndex, double timeDelta );
+
+/// Control loop configuration. Zero-initialized members use default values
+typedef struct ControlLoopSettings
+{
+  double stepPeriod;                      ///< Control step period (in seconds)
+  int priority;                           ///< SCHED_FIFO real-time priority (1-99) of loop thread, or 0 for default scheduling
+  double slowStepPeriod;                  ///< Slow step period (in seconds), rounded to a multiple of stepPeriod. Only used by ControlLoop_StartMultiRate
+  uint64_t maxDeadlineMisses;             ///< Number of consecutive deadline misses after which control is degraded to CONTROL_PASSIVE state, or 0 to never degrade
+  void (*setControlState)( enum ControlState );   ///< Reference to plugin SetControlState implementation, called on loop thread for degradation
+  const ControlPlacement* placement;      ///< CPUs and memory node of loop threads (should pass ControlPlacement_Validate without errors, and loop start fails if it can't be applied), or NULL for default
+}
+ControlLoopSettings;
+
+/// Control loop execution status, readable from other threads
+typedef struct ControlLoopStatus
+{
+  uint64_t stepsCount;                    ///< Number of steps executed since loop start
+  uint64_t slowStepsCount;                ///< Number of slow steps executed since loop start
+  double lastTimeDelta;                   ///< Time delta (in seconds) passed to the last step
+  double lastWakeupLatency;               ///< Delay (in seconds) between last deadline and actual loop thread wake up
+  double maxWakeupLatency;                ///< Maximum wake up delay (in seconds) since loop start (scheduling jitter)
+  double lastStepDuration;                ///< Execution time (in seconds) of last cycle steps
+  double maxStepDuration;                 ///< Maximum execution time (in seconds) of cycle steps since loop start
+  uint64_t deadlineMissesCount;           ///< Number of cycles whose steps didn't end before the next deadline, since loop start
+  uint64_t consecutiveDeadlineMisses;     ///< Number of deadline misses since the last cycle that met its deadline
+  uint64_t degradationsCount;             ///< Number of times control was degraded to CONTROL_PASSIVE state for consecutive deadline misses
+  int cpu;                                ///< CPU the loop thread ran its last cycle on
+  uint64_t migrationsCount;               ///< Number of times the loop thread changed CPUs between cycles
+  uint64_t involuntarySwitchesCount;      ///< Number of times the loop thread was preempted by other tasks (interference)
+}
+ControlLoopStatus;
+
+/// Opaque control loop data
+typedef struct _ControlLoopData ControlLoopData;
+/// Opaque reference to running control loop
+typedef ControlLoopData* ControlLoop;
+
+/// @brief Starts control loop thread with given settings
+/// @param[in] settings reference to loop configuration
+/// @param[in] runStep control step function, called once per period on loop thread
+/// @param[in] stepData reference to user data passed to each step call
+/// @return reference to running loop on success, NULL otherwise (e.g. invalid period or not permitted real-time priority)
+ControlLoop ControlLoop_Start( const ControlLoopSettings* settings, ControlStepFunction runStep, void* stepData );
+
+/// @brief Starts control loop thread running steps at 2 different rates, like joint level control and joint/axis conversion passes of ROBOT_CONTROL_MULTIRATE_INTERFACE
+///
+/// Both steps run sequentially on the same thread (slow step first, on cycles where both are due), so they need no synchronization between them
+/// @param[in] settings reference to loop configuration, with both step periods
+/// @param[in] runStep control step function, called once per stepPeriod on loop thread
+/// @param[in] runSlowStep control step function, called once per slowStepPeriod on loop thread, with time delta measured since its last call
+/// @param[in] stepData reference to user data passed to each call of both step functions
+/// @return reference to running loop on success, NULL otherwise (e.g. invalid periods or not permitted real-time priority)
+ControlLoop ControlLoop_StartMultiRate( const ControlLoopSettings* settings, ControlStepFunction runStep, ControlStepFunction runSlowStep, void* stepData );
+
+/// @brief Starts control loop running device I/O and control computation phases (like those of ROBOT_CONTROL_PHASES_INTERFACE) in parallel
+///
+/// On each cycle, the I/O phase runs on a second thread and the compute phase on the loop thread, over alternating halves of a double buffered data set:
+/// the I/O phase writes setpoints computed on the last cycle and reads new measures into one half, while the compute phase processes measures read
+/// on the last cycle from the other half. A host would usually call WriteSetpoints and ReadMeasures with its buffer index joint lists in the I/O phase, and
+/// ComputeControl with its buffer index joint lists in the compute phase. This adds one cycle of latency but removes I/O time from the cycle critical path
+/// @param[in] settings reference to loop configuration (both threads get the same priority)
+/// @param[in] runIOPhase device I/O phase function, called once per period on I/O thread
+/// @param[in] runComputePhase control computation phase function, called once per period on loop thread, concurrently with I/O phase
+/// @param[in] stepData reference to user data passed to each call of both phase functions
+/// @return reference to running loop on success, NULL otherwise (e.g. invalid period or not permitted real-time priority)
+ControlLoop ControlLoop_StartPipelined( const ControlLoopSettings* settings, ControlPhaseFunction runIOPhase, ControlPhaseFunction runComputePhase, void* stepData );
+
+/// @brief Runs control steps back-to-back on the calling thread over a virtual clock, for faster than real-time simulation and regression tests
+///
+/// No wall clock is read: steps receive the fixed settings stepPeriod as timeDelta, or successive values of a time deltas script, so that
+/// deterministic plugins produce bit-identical results across runs. Steps run in the same order as with ControlLoop_StartMultiRate
+/// @param[in] settings reference to loop configuration (stepPeriod, and slowStepPeriod if runSlowStep is used, in which case both must be valid even with time deltas list)
+/// @param[in] timeDeltasList list of time deltas (in seconds) passed to successive steps, restarted from the beginning when exhausted, or NULL for fixed stepPeriod
+/// @param[in] timeDeltasNumber number of elements in time deltas list
+/// @param[in] stepsNumber number of steps to be run
+/// @param[in] runStep control step function, called stepsNumber times
+/// @param[in] runSlowStep control step function called once every slowStepPeriod/stepPeriod steps, with the sum of their time deltas, or NULL
+/// @param[in] stepData reference to user data passed to each call of both step functions
+/// @return number of steps run (0 for invalid settings)
+uint64_t ControlLoop_RunVirtual( const ControlLoopSettings* settings, const double* timeDeltasList, size_t timeDeltasNumber, uint64_t stepsNumber, 
+                                 ControlStepFunction runStep, ControlStepFunction runSlowStep, void* stepData );
+
+/// @brief Stops control loop (after its current step ends) and deallocates its data
+/// @param[in] loop reference to running control loop
+void ControlLoop_Stop( ControlLoop loop );
+
+/// @brief Gets current execution status of control loop
+/// @param[in] loop reference to running control loop
+/// @param[out] status reference to status structure to be filled
+void ControlLoop_GetStatus( ControlLoop loop, ControlLoopStatus* status );
+
+#endif  // CONTROL_LOOP_H
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "control_placement.h"
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define ISOLATED_CPUS_FILE "/sys/devices/system/cpu/isolated"
+#define NODE_MEMORY_FILE "/sys/devices/system/node/has_memory"
+#define MAX_NODES_NUMBER 1024
+#define LIST_BUFFER_SIZE 4096
+
+
+// Parses kernel CPU/node list format (e.g. "0,2-5,8") into set of bits
+static bool ReadListFile( const char* filePath, unsigned long* bitsList, size_t maxBitsNumber )
+{
+  memset( bitsList, 0, maxBitsNumber / 8 );
+  
+  char listBuffer[ LIST_BUFFER_SIZE ] = "";
+  FILE* listFile = fopen( filePath, "r" );
+  if( listFile == NULL ) return false;
+  bool isRead = ( fgets( listBuffer, sizeof(listBuffer), listFile ) != NULL );
+  fclose( listFile );
+  if( !isRead ) return true;
+  
+  const size_t BITS_PER_ELEMENT = 8 * sizeof(unsigned long);
+  char* parserState;
+  char* rangeString = strtok_r( listBuffer, ",\n", &parserState );
+  while( rangeString != NULL )
+  {
+    unsigned long firstIndex, lastIndex;
+    int valuesNumber = sscanf( rangeString, "%lu-%lu", &firstIndex, &lastIndex );
+    if( valuesNumber == 1 ) lastIndex = firstIndex;
+    if( valuesNumber >= 1 )
+    {
+      for( unsigned long index = firstIndex; index <= lastIndex && index < maxBitsNumber; index++ )
+        bitsList[ index / BITS_PER_ELEMENT ] |= 1UL << ( index % BITS_PER_ELEMENT );
+    }
+    rangeString = strtok_r( NULL, ",\n", &parserState );
+  }
+  
+  return true;
+}
+
+static bool IsBitSet( const unsigned long* bitsList, size_t index )
+{
+  const size_t BITS_PER_ELEMENT = 8 * sizeof(unsigned long);
+  return ( bitsList[ index / BITS_PER_ELEMENT ] & ( 1UL << ( index % BITS_PER_ELEMENT ) ) );
+}
+
+size_t ControlPlacement_GetIsolatedCPUs( int* cpusList, size_t maxCPUsNumber )
+{
+  unsigned long isolatedCPUs[ CPU_SETSIZE / ( 8 * sizeof(unsigned long) ) ];
+  if( !ReadListFile( ISOLATED_CPUS_FILE, isolatedCPUs, CPU_SETSIZE ) ) return 0;
+  
+  size_t cpusNumber = 0;
+  for( int cpu = 0; cpu < CPU_SETSIZE && cpusNumber < maxCPUsNumber; cpu++ )
+  {
+    if( IsBitSet( isolatedCPUs, (size_t) cpu ) ) cpusList[ cpusNumber++ ] = cpu;
+  }
+  
+  return cpusNumber;
+}
+
+uint32_t ControlPlacement_Validate( const ControlPlacement* placement )
+{
+  uint32_t issues = 0;
+  
+  if( placement->cpusList != NULL )
+  {
+    cpu_set_t availableCPUs;
+    CPU_ZERO( &availableCPUs );
+    sched_getaffinity( 0, sizeof(cpu_set_t), &availableCPUs );
+    unsigned long isolatedCPUs[ CPU_SETSIZE / ( 8 * sizeof(unsigned long) ) ];
+    ReadListFile( ISOLATED_CPUS_FILE, isolatedCPUs, CPU_SETSIZE );
+    
+    if( placement->cpusNumber == 0 ) issues |= PLACEMENT_CPU_UNAVAILABLE;
+    for( size_t cpuIndex = 0; cpuIndex < placement->cpusNumber; cpuIndex++ )
+    {
+      int cpu = placement->cpusList[ cpuIndex ];
+      if( cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET( cpu, &availableCPUs ) ) issues |= PLACEMENT_CPU_UNAVAILABLE;
+      else if( !IsBitSet( isolatedCPUs, (size_t) cpu ) ) issues |= PLACEMENT_CPU_NOT_ISOLATED;
+    }
+  }
+  
+  if( placement->isMemoryBound )
+  {
+    unsigned long memoryNodes[ MAX_NODES_NUMBER / ( 8 * sizeof(unsigned long) ) ];
+    if( placement->memoryNode < 0 || placement->memoryNode >= MAX_NODES_NUMBER || !ReadListFile( NODE_MEMORY_FILE, memoryNodes, MAX_NODES_NUMBER ) 
+        || !IsBitSet( memoryNodes, (size_t) placement->memoryNode ) ) issues |= PLACEMENT_NODE_UNAVAILABLE;
+  }
+  
+  return issues;
+}
+
+bool ControlPlacement_ApplyToThread( const ControlPlacement* placement )
+{
+  if( placement->cpusList != NULL )
+  {
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    for( size_t cpuIndex = 0; cpuIndex < placement->cpusNumber; cpuIndex++ )
+    {
+      if( placement->cpusList[ cpuIndex ] >= 0 && placement->cpusList[ cpuIndex ] < CPU_SETSIZE ) CPU_SET( placement->cpusList[ cpuIndex ], &cpuSet );
+    }
+    if( sched_setaffinity( 0, sizeof(cpu_set_t), &cpuSet ) != 0 ) return false;
+  }
+  
+  if( placement->isMemoryBound )
+  {
+    if( placement->memoryNode < 0 || placement->memoryNode >= MAX_NODES_NUMBER ) return false;
+    unsigned long nodeMask[ MAX_NODES_NUMBER / ( 8 * sizeof(unsigned long) ) ] = { 0 };
+    nodeMask[ placement->memoryNode / ( 8 * sizeof(unsigned long) ) ] = 1UL << ( placement->memoryNode % ( 8 * sizeof(unsigned long) ) );
+    // Memory policy (unlike CPU affinity) has no glibc wrapper without libnuma
+    if( syscall( SYS_set_mempolicy, MPOL_BIND, nodeMask, (unsigned long) MAX_NODES_NUMBER ) != 0 ) return false;
+  }
+  
+  return true;
+}
+
+int ControlPlacement_GetThreadID( void )
+{
+  return (int) syscall( SYS_gettid );
+}
+
+uint64_t ControlPlacement_GetInvoluntarySwitchesCount( int threadID )
+{
+  char statusFilePath[ 64 ];
+  snprintf( statusFilePath, sizeof(statusFilePath), "/proc/self/task/%d/status", threadID );
+  FILE* statusFile = fopen( statusFilePath, "r" );
+  if( statusFile == NULL ) return 0;
+  
+  uint64_t switchesCount = 0;
+  char lineBuffer[ 256 ];
+  while( fgets( lineBuffer, sizeof(lineBuffer), statusFile ) != NULL )
+  {
+    unsigned long long lineCount;
+    if( sscanf( lineBuffer, "nonvoluntary_ctxt_switches: %llu", &lineCount ) == 1 ) switchesCount = (uint64_t) lineCount;
+  }
+  fclose( statusFile );
+  
+  return switchesCount;
+}
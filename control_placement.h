@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file control_placement.h
+/// @brief CPU and memory placement of control threads
+///
+/// Placements restrict executor threads to given CPUs (usually ones isolated from the kernel scheduler with the isolcpus boot parameter)
+/// and memory allocations to a given NUMA node. They can be validated against the machine configuration, and interference suffered
+/// by placed threads (preemptions by other tasks sharing their CPUs) can be measured while they run
+
+#ifndef CONTROL_PLACEMENT_H
+#define CONTROL_PLACEMENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Control thread placement issues, as bit flags
+enum ControlPlacementIssue
+{
+  PLACEMENT_CPU_UNAVAILABLE = 0x01,       ///< Some of the CPUs are offline or not allowed for the process
+  PLACEMENT_NODE_UNAVAILABLE = 0x02,      ///< Memory node doesn't exist or has no memory
+  PLACEMENT_CPU_NOT_ISOLATED = 0x04,      ///< Some of the CPUs are not isolated, so other tasks may be scheduled on them
+  PLACEMENT_ERRORS = 0x03                 ///< Issues that prevent placement from being applied
+};
+
+/// Control thread placement configuration. Zero-initialized members use default values (no restriction)
+typedef struct ControlPlacement
+{
+  const int* cpusList;                    ///< List of CPUs the thread may run on, or NULL for any
+  size_t cpusNumber;                      ///< Number of elements in CPUs list
+  bool isMemoryBound;                     ///< Whether thread memory is allocated only on memoryNode, or on any node
+  int memoryNode;                         ///< NUMA node where thread memory is allocated, if isMemoryBound is set
+}
+ControlPlacement;
+
+/// @brief Gets CPUs isolated from the general kernel scheduler on this machine
+/// @param[out] cpusList list to be filled with isolated CPU indexes
+/// @param[in] maxCPUsNumber maximum number of elements in CPUs list
+/// @return number of isolated CPUs written to list
+size_t ControlPlacement_GetIsolatedCPUs( int* cpusList, size_t maxCPUsNumber );
+
+/// @brief Checks placement against CPUs and memory nodes available on this machine
+/// @param[in] placement reference to placement configuration
+/// @return placement issues found, as ControlPlacementIssue flags (0 for none)
+uint32_t ControlPlacement_Validate( const ControlPlacement* placement );
+
+/// @brief Applies placement to calling thread. Should be called on thread start, before it allocates memory
+/// @param[in] placement reference to placement configuration
+/// @return true on success, false otherwise
+bool ControlPlacement_ApplyToThread( const ControlPlacement* placement );
+
+/// @brief Gets identifier of calling thread, to be used by ControlPlacement_GetInvoluntarySwitchesCount
+/// @return kernel thread identifier
+int ControlPlacement_GetThreadID( void );
+
+/// @brief Measures interference suffered by thread, as number of times it was preempted by other tasks. Should not be called on control threads
+/// @param[in] threadID kernel identifier of thread of this process
+/// @return number of involuntary context switches of thread since it started (0 if it can't be read)
+uint64_t ControlPlacement_GetInvoluntarySwitchesCount( int threadID );
+
+#endif  // CONTROL_PLACEMENT_H
@@ -0,0 +1,297 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "control_profiler.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Log-linear buckets: values below SUB_BUCKETS_NUMBER have one bucket each, higher ones are split in
+// half ranges of SUB_BUCKETS_NUMBER / 2 buckets per power of 2 (HDR histogram with 8 bits of precision)
+#define SUB_BUCKET_BITS 8
+#define SUB_BUCKETS_NUMBER ( 1 << SUB_BUCKET_BITS )
+#define SUB_BUCKETS_HALF ( SUB_BUCKETS_NUMBER / 2 )
+#define MAX_VALUE_BITS 40
+#define MAX_VALUE ( ( UINT64_C(1) << MAX_VALUE_BITS ) - 1 )
+#define BUCKETS_NUMBER ( ( MAX_VALUE_BITS - SUB_BUCKET_BITS + 2 ) * SUB_BUCKETS_HALF )
+
+struct _LatencyHistogramData
+{
+  atomic_uint_fast64_t countsList[ BUCKETS_NUMBER ];
+  atomic_uint_fast64_t totalCount;
+  atomic_uint_fast64_t maxValue;
+};
+
+
+static inline size_t GetBucketIndex( uint64_t value )
+{
+  if( value > MAX_VALUE ) value = MAX_VALUE;
+  if( value < SUB_BUCKETS_NUMBER ) return (size_t) value;
+ 
+  int shift = ( 63 - __builtin_clzll( value ) ) - SUB_BUCKET_BITS + 1;
+  return (size_t) shift * SUB_BUCKETS_HALF + (size_t) ( value >> shift );
+}
+
+static inline uint64_t GetBucketHighestValue( size_t bucketIndex )
+{
+  if( bucketIndex < SUB_BUCKETS_NUMBER ) return bucketIndex;
+ 
+  size_t shift = bucketIndex / SUB_BUCKETS_HALF - 1;
+  uint64_t subBucketIndex = bucketIndex - shift * SUB_BUCKETS_HALF;
+  return ( ( subBucketIndex + 1 ) << shift ) - 1;
+}
+
+LatencyHistogram LatencyHistogram_Create( void )
+{
+  LatencyHistogram newHistogram = (LatencyHistogram) malloc( sizeof(LatencyHistogramData) );
+  if( newHistogram == NULL ) return NULL;
+ 
+  for( size_t bucketIndex = 0; bucketIndex < BUCKETS_NUMBER; bucketIndex++ )
+    atomic_init( &(newHistogram->countsList[ bucketIndex ]), 0 );
+  atomic_init( &(newHistogram->totalCount), 0 );
+  atomic_init( &(newHistogram->maxValue), 0 );
+ 
+  return newHistogram;
+}
+
+void LatencyHistogram_Discard( LatencyHistogram histogram )
+{
+  free( histogram );
+}
+
+void LatencyHistogram_Record( LatencyHistogram histogram, uint64_t valueNs )
+{
+  atomic_fetch_add_explicit( &(histogram->countsList[ GetBucketIndex( valueNs ) ]), 1, memory_order_relaxed );
+  atomic_fetch_add_explicit( &(histogram->totalCount), 1, memory_order_relaxed );
+ 
+  uint_fast64_t maxValue = atomic_load_explicit( &(histogram->maxValue), memory_order_relaxed );
+  while( valueNs > maxValue && !atomic_compare_exchange_weak_explicit( &(histogram->maxValue), &maxValue, valueNs,
+                                                                       memory_order_relaxed, memory_order_relaxed ) );
+}
+
+void LatencyHistogram_Reset( LatencyHistogram histogram )
+{
+  for( size_t bucketIndex = 0; bucketIndex < BUCKETS_NUMBER; bucketIndex++ )
+    atomic_store_explicit( &(histogram->countsList[ bucketIndex ]), 0, memory_order_relaxed );
+  atomic_store_explicit( &(histogram->totalCount), 0, memory_order_relaxed );
+  atomic_store_explicit( &(histogram->maxValue), 0, memory_order_relaxed );
+}
+
+uint64_t LatencyHistogram_GetCount( LatencyHistogram histogram )
+{
+  return atomic_load_explicit( &(histogram->totalCount), memory_order_relaxed );
+}
+
+uint64_t LatencyHistogram_GetMax( LatencyHistogram histogram )
+{
+  return atomic_load_explicit( &(histogram->maxValue), memory_order_relaxed );
+}
+
+uint64_t LatencyHistogram_GetPercentile( LatencyHistogram histogram, double percentile )
+{
+  // Buckets are summed instead of using total count, that may be ahead of them while values are being recorded
+  uint64_t totalCount = 0;
+  for( size_t bucketIndex = 0; bucketIndex < BUCKETS_NUMBER; bucketIndex++ )
+    totalCount += atomic_load_explicit( &(histogram->countsList[ bucketIndex ]), memory_order_relaxed );
+  if( totalCount == 0 ) return 0;
+ 
+  if( percentile < 0.0 ) percentile = 0.0;
+  else if( percentile > 100.0 ) percentile = 100.0;
+  uint64_t targetCount = (uint64_t) ( percentile / 100.0 * totalCount + 0.5 );
+  if( targetCount == 0 ) targetCount = 1;
+ 
+  uint64_t cumulativeCount = 0;
+  for( size_t bucketIndex = 0; bucketIndex < BUCKETS_NUMBER; bucketIndex++ )
+  {
+    cumulativeCount += atomic_load_explicit( &(histogram->countsList[ bucketIndex ]), memory_order_relaxed );
+    if( cumulativeCount >= targetCount )
+    {
+      uint64_t bucketValue = GetBucketHighestValue( bucketIndex );
+      uint64_t maxValue = LatencyHistogram_GetMax( histogram );
+      return ( bucketValue < maxValue || maxValue == 0 ) ? bucketValue : maxValue;
+    }
+  }
+ 
+  return LatencyHistogram_GetMax( histogram );
+}
+
+
+#define CALL_INDEX( rtype, Interface, name, ... ) CALL_##name,
+#define CALL_NAME( rtype, Interface, name, ... ) #name,
+
+enum { ROBOT_CONTROL_INTERFACE( , CALL_INDEX ) CALLS_NUMBER };
+static const char* CALL_NAMES[ CALLS_NUMBER ] = { ROBOT_CONTROL_INTERFACE( , CALL_NAME ) };
+
+static RobotControlFunctions plugin;
+static LatencyHistogram callLatenciesList[ CALLS_NUMBER ];
+static LatencyHistogram stepJitter = NULL;
+static int64_t lastStepTimeNs = -1, lastStepIntervalNs = -1;
+
+static inline int64_t GetTimeNs( void )
+{
+  struct timespec time;
+  clock_gettime( CLOCK_MONOTONIC, &time );
+  return (int64_t) time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+// Calls plugin function with given arguments, recording its duration
+#define PROFILE_CALL( call, callIndex ) \
+        int64_t startTimeNs = GetTimeNs(); \
+        call; \
+        LatencyHistogram_Record( callLatenciesList[ callIndex ], (uint64_t) ( GetTimeNs() - startTimeNs ) );
+
+static bool ProfiledInitController( const char* configurationString )
+{
+  bool result;
+  PROFILE_CALL( result = plugin.InitController( configurationString ), CALL_InitController );
+  return result;
+}
+
+static void ProfiledEndController( void )
+{
+  PROFILE_CALL( plugin.EndController(), CALL_EndController );
+}
+
+static size_t ProfiledGetJointsNumber( void )
+{
+  size_t result;
+  PROFILE_CALL( result = plugin.GetJointsNumber(), CALL_GetJointsNumber );
+  return result;
+}
+
+static const char** ProfiledGetJointNamesList( void )
+{
+  const char** result;
+  PROFILE_CALL( result = plugin.GetJointNamesList(), CALL_GetJointNamesList );
+  return result;
+}
+
+static size_t ProfiledGetAxesNumber( void )
+{
+  size_t result;
+  PROFILE_CALL( result = plugin.GetAxesNumber(), CALL_GetAxesNumber );
+  return result;
+}
+
+static const char** ProfiledGetAxisNamesList( void )
+{
+  const char** result;
+  PROFILE_CALL( result = plugin.GetAxisNamesList(), CALL_GetAxisNamesList );
+  return result;
+}
+
+static void ProfiledSetControlState( enum ControlState controlState )
+{
+  PROFILE_CALL( plugin.SetControlState( controlState ), CALL_SetControlState );
+}
+
+static void ProfiledRunControlStep( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList,
+                                    DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+{
+  PROFILE_CALL( plugin.RunControlStep( jointMeasuresList, axisMeasuresList, jointSetpointsList, axisSetpointsList, timeDelta ), CALL_RunControlStep );
+ 
+  if( lastStepTimeNs >= 0 )
+  {
+    int64_t stepIntervalNs = startTimeNs - lastStepTimeNs;
+    if( lastStepIntervalNs >= 0 ) LatencyHistogram_Record( stepJitter, (uint64_t) llabs( stepIntervalNs - lastStepIntervalNs ) );
+    lastStepIntervalNs = stepIntervalNs;
+  }
+  lastStepTimeNs = startTimeNs;
+}
+
+static size_t ProfiledGetExtraInputsNumber( void )
+{
+  size_t result;
+  PROFILE_CALL( result = plugin.GetExtraInputsNumber(), CALL_GetExtraInputsNumber );
+  return result;
+}
+
+static void ProfiledSetExtraInputsList( double* inputsList )
+{
+  PROFILE_CALL( plugin.SetExtraInputsList( inputsList ), CALL_SetExtraInputsList );
+}
+
+static size_t ProfiledGetExtraOutputsNumber( void )
+{
+  size_t result;
+  PROFILE_CALL( result = plugin.GetExtraOutputsNumber(), CALL_GetExtraOutputsNumber );
+  return result;
+}
+
+static void ProfiledGetExtraOutputsList( double* outputsList )
+{
+  PROFILE_CALL( plugin.GetExtraOutputsList( outputsList ), CALL_GetExtraOutputsList );
+}
+
+#define PROFILED_FUNCTION_REFERENCE( rtype, Interface, name, ... ) .name = Profiled##name,
+static const RobotControlFunctions PROFILED_FUNCTIONS = { ROBOT_CONTROL_INTERFACE( , PROFILED_FUNCTION_REFERENCE ) };
+
+bool ControlProfiler_Init( const RobotControlFunctions* functions, RobotControlFunctions* profiledFunctions )
+{
+  if( functions == NULL || profiledFunctions == NULL ) return false;
+  if( stepJitter != NULL ) return false;
+ 
+  bool success = ( ( stepJitter = LatencyHistogram_Create() ) != NULL );
+  for( size_t callIndex = 0; callIndex < CALLS_NUMBER; callIndex++ )
+    success = ( ( callLatenciesList[ callIndex ] = LatencyHistogram_Create() ) != NULL ) && success;
+ 
+  if( !success )
+  {
+    ControlProfiler_End();
+    return false;
+  }
+ 
+  plugin = *functions;
+  lastStepTimeNs = lastStepIntervalNs = -1;
+  *profiledFunctions = PROFILED_FUNCTIONS;
+ 
+  return true;
+}
+
+void ControlProfiler_End( void )
+{
+  for( size_t callIndex = 0; callIndex < CALLS_NUMBER; callIndex++ )
+  {
+    LatencyHistogram_Discard( callLatenciesList[ callIndex ] );
+    callLatenciesList[ callIndex ] = NULL;
+  }
+  LatencyHistogram_Discard( stepJitter );
+  stepJitter = NULL;
+}
+
+LatencyHistogram ControlProfiler_GetCallLatency( const char* functionName )
+{
+  if( functionName == NULL ) return NULL;
+ 
+  for( size_t callIndex = 0; callIndex < CALLS_NUMBER; callIndex++ )
+  {
+    if( strcmp( CALL_NAMES[ callIndex ], functionName ) == 0 ) return callLatenciesList[ callIndex ];
+  }
+ 
+  return NULL;
+}
+
+LatencyHistogram ControlProfiler_GetStepJitter( void )
+{
+  return stepJitter;
+}
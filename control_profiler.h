@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file control_profiler.h
+/// @brief Optional latency/jitter instrumentation of robot control interface calls
+///
+/// Plugin interface functions are replaced by wrappers recording each call duration, and the variation of the interval between
+/// consecutive control steps (jitter), in lock-free HDR (high dynamic range) histograms, that may be read from any other thread
+/// while the control loop runs
+
+#ifndef CONTROL_PROFILER_H
+#define CONTROL_PROFILER_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Opaque latency histogram data
+typedef struct _LatencyHistogramData LatencyHistogramData;
+/// Opaque reference to latency histogram
+typedef LatencyHistogramData* LatencyHistogram;
+
+/// @brief Creates empty latency histogram, covering values from 1 nanosecond to about 18 minutes with less than 0.8% (1/128) relative error
+/// @return reference to created histogram on success, NULL otherwise
+LatencyHistogram LatencyHistogram_Create( void );
+
+/// @brief Deallocates data of given latency histogram
+/// @param[in] histogram reference to latency histogram
+void LatencyHistogram_Discard( LatencyHistogram histogram );
+
+/// @brief Adds value to latency histogram (lock-free, may be called concurrently from multiple threads)
+/// @param[in] histogram reference to latency histogram
+/// @param[in] valueNs recorded value (in nanoseconds)
+void LatencyHistogram_Record( LatencyHistogram histogram, uint64_t valueNs );
+
+/// @brief Clears all recorded values of latency histogram
+/// @param[in] histogram reference to latency histogram
+void LatencyHistogram_Reset( LatencyHistogram histogram );
+
+/// @brief Gets number of values recorded in latency histogram
+/// @param[in] histogram reference to latency histogram
+/// @return number of recorded values
+uint64_t LatencyHistogram_GetCount( LatencyHistogram histogram );
+
+/// @brief Gets maximum value recorded in latency histogram
+/// @param[in] histogram reference to latency histogram
+/// @return exact maximum value (in nanoseconds), or 0 if no value was recorded
+uint64_t LatencyHistogram_GetMax( LatencyHistogram histogram );
+
+/// @brief Gets value below which a given percentage of latency histogram values fall
+/// @param[in] histogram reference to latency histogram
+/// @param[in] percentile percentage of values (from 0.0 to 100.0, e.g. 99.9)
+/// @return highest value (in nanoseconds) of the percentile histogram bucket (never below recorded values, up to 1/128 above them, and 
+///         limited to the maximum recorded value), or 0 if no value was recorded
+uint64_t LatencyHistogram_GetPercentile( LatencyHistogram histogram, double percentile );
+
+/// @brief Starts profiling of given plugin interface functions. Only one plugin may be profiled at a time, as its interface functions keep no instance state
+/// @param[in] functions reference to table of plugin interface functions to be profiled
+/// @param[out] profiledFunctions reference to table filled with profiling wrappers, to be used by host instead of the original functions
+/// @return true on success, false otherwise (e.g. profiling already started)
+bool ControlProfiler_Init( const RobotControlFunctions* functions, RobotControlFunctions* profiledFunctions );
+
+/// @brief Stops profiling and deallocates histograms. Profiling wrappers must not be called afterwards
+void ControlProfiler_End( void );
+
+/// @brief Gets histogram of call durations of a profiled interface function
+/// @param[in] functionName name of ROBOT_CONTROL_INTERFACE function (e.g. "RunControlStep")
+/// @return reference to latency histogram on success, NULL for unknown function name or not started profiling
+LatencyHistogram ControlProfiler_GetCallLatency( const char* functionName );
+
+/// @brief Gets histogram of differences between consecutive RunControlStep call intervals (cycle-to-cycle jitter)
+/// @return reference to latency histogram on success, NULL for not started profiling
+LatencyHistogram ControlProfiler_GetStepJitter( void );
+
+#endif  // CONTROL_PROFILER_H
@@ -0,0 +1,339 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "dof_codec.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_KEYFRAME 0x01
+
+#define HEADER_SIZE 3
+#define WIDTH_BITS 7
+#define MAX_QUANTIZED_VALUE 4611686018427387904.0     // 2^62, keeping conversions from double defined
+
+// Offsets of DoFVariables fields, in DoFVariableFlag bit order
+static const size_t FIELD_OFFSETS[ DOF_VARIABLES_NUMBER ] = { offsetof(DoFVariables, position), offsetof(DoFVariables, velocity), 
+                                                              offsetof(DoFVariables, force), offsetof(DoFVariables, acceleration), 
+                                                              offsetof(DoFVariables, inertia), offsetof(DoFVariables, stiffness), 
+                                                              offsetof(DoFVariables, damping) };
+
+typedef struct BitStream
+{
+  uint8_t* data;
+  size_t size;
+  size_t bitPosition;
+  bool isOverflown;                       // Set when reading or writing beyond data size
+}
+BitStream;
+
+struct _DoFEncoderData
+{
+  size_t dofsNumber;
+  double precisionsList[ DOF_VARIABLES_NUMBER ];
+  size_t keyframeInterval;
+  size_t framesCount;                     // Frames encoded since last keyframe
+  bool isKeyframeRequested;
+  uint16_t sequence;
+  int64_t* quantizedValues;               // Per field arrays of last encoded values, as reconstructed by decoders
+  int64_t* newValues;
+  uint64_t* codesList;
+};
+
+struct _DoFDecoderData
+{
+  size_t dofsNumber;
+  double precisionsList[ DOF_VARIABLES_NUMBER ];
+  uint16_t sequence;
+  bool hasSequence;
+  bool hasReference;                      // Set while last decoded values are available for delta frames
+  uint64_t lostFramesCount;
+  int64_t* quantizedValues;
+  int64_t* newValues;
+};
+
+
+static void WriteBits( BitStream* stream, uint64_t value, unsigned int bitsNumber )
+{
+  while( bitsNumber > 0 )
+  {
+    size_t byteIndex = stream->bitPosition / 8;
+    if( byteIndex >= stream->size )
+    {
+      stream->isOverflown = true;
+      return;
+    }
+    
+    unsigned int bitOffset = stream->bitPosition % 8;
+    unsigned int chunkBitsNumber = ( 8 - bitOffset < bitsNumber ) ? 8 - bitOffset : bitsNumber;
+    if( bitOffset == 0 ) stream->data[ byteIndex ] = 0;
+    stream->data[ byteIndex ] |= (uint8_t) ( ( value & ( ( 1U << chunkBitsNumber ) - 1 ) ) << bitOffset );
+    
+    value >>= chunkBitsNumber;
+    bitsNumber -= chunkBitsNumber;
+    stream->bitPosition += chunkBitsNumber;
+  }
+}
+
+static uint64_t ReadBits( BitStream* stream, unsigned int bitsNumber )
+{
+  uint64_t value = 0;
+  unsigned int valueBitsNumber = 0;
+  while( valueBitsNumber < bitsNumber )
+  {
+    size_t byteIndex = stream->bitPosition / 8;
+    if( byteIndex >= stream->size )
+    {
+      stream->isOverflown = true;
+      return 0;
+    }
+    
+    unsigned int bitOffset = stream->bitPosition % 8;
+    unsigned int chunkBitsNumber = ( 8 - bitOffset < bitsNumber - valueBitsNumber ) ? 8 - bitOffset : bitsNumber - valueBitsNumber;
+    uint64_t chunk = ( stream->data[ byteIndex ] >> bitOffset ) & ( ( 1U << chunkBitsNumber ) - 1 );
+    value |= chunk << valueBitsNumber;
+    
+    valueBitsNumber += chunkBitsNumber;
+    stream->bitPosition += chunkBitsNumber;
+  }
+  
+  return value;
+}
+
+// Maps signed values to unsigned ones with magnitude order (0, -1, 1, -2, 2, ...), so that small deltas of any sign need few bits
+static inline uint64_t EncodeZigZag( int64_t value ) { return ( (uint64_t) value << 1 ) ^ (uint64_t) ( value >> 63 ); }
+static inline int64_t DecodeZigZag( uint64_t code ) { return (int64_t) ( ( code >> 1 ) ^ ( ~( code & 1 ) + 1 ) ); }
+
+static inline unsigned int GetBitWidth( uint64_t code )
+{
+  return ( code == 0 ) ? 0 : 64 - (unsigned int) __builtin_clzll( code );
+}
+
+static inline int64_t Quantize( double value, double precision )
+{
+  double quantizedValue = round( value / precision );
+  if( isnan( quantizedValue ) ) return 0;
+  if( quantizedValue > MAX_QUANTIZED_VALUE ) return (int64_t) MAX_QUANTIZED_VALUE;
+  if( quantizedValue < -MAX_QUANTIZED_VALUE ) return (int64_t) -MAX_QUANTIZED_VALUE;
+  
+  return (int64_t) quantizedValue;
+}
+
+static void SetPrecisions( double* precisionsList, const DoFVariables* precision )
+{
+  for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+  {
+    memcpy( &(precisionsList[ fieldIndex ]), (const uint8_t*) precision + FIELD_OFFSETS[ fieldIndex ], sizeof(double) );
+    if( !( precisionsList[ fieldIndex ] > 0.0 ) || isinf( precisionsList[ fieldIndex ] ) ) precisionsList[ fieldIndex ] = 0.0;
+  }
+}
+
+size_t DoFCodec_GetMaxFrameSize( size_t dofsNumber )
+{
+  return HEADER_SIZE + ( DOF_VARIABLES_NUMBER * ( WIDTH_BITS + dofsNumber * 64 ) + 7 ) / 8;
+}
+
+DoFEncoder DoFEncoder_Create( size_t dofsNumber, const DoFVariables* precision, size_t keyframeInterval )
+{
+  if( dofsNumber == 0 || precision == NULL ) return NULL;
+  
+  DoFEncoder newEncoder = (DoFEncoder) calloc( 1, sizeof(DoFEncoderData) );
+  if( newEncoder == NULL ) return NULL;
+  
+  newEncoder->dofsNumber = dofsNumber;
+  SetPrecisions( newEncoder->precisionsList, precision );
+  newEncoder->keyframeInterval = keyframeInterval;
+  newEncoder->isKeyframeRequested = true;
+  
+  newEncoder->quantizedValues = (int64_t*) calloc( DOF_VARIABLES_NUMBER * dofsNumber, sizeof(int64_t) );
+  newEncoder->newValues = (int64_t*) calloc( DOF_VARIABLES_NUMBER * dofsNumber, sizeof(int64_t) );
+  newEncoder->codesList = (uint64_t*) calloc( dofsNumber, sizeof(uint64_t) );
+  if( newEncoder->quantizedValues == NULL || newEncoder->newValues == NULL || newEncoder->codesList == NULL )
+  {
+    DoFEncoder_Discard( newEncoder );
+    return NULL;
+  }
+  
+  return newEncoder;
+}
+
+void DoFEncoder_Discard( DoFEncoder encoder )
+{
+  if( encoder == NULL ) return;
+  
+  free( encoder->quantizedValues );
+  free( encoder->newValues );
+  free( encoder->codesList );
+  free( encoder );
+}
+
+void DoFEncoder_RequestKeyframe( DoFEncoder encoder )
+{
+  encoder->isKeyframeRequested = true;
+}
+
+size_t DoFEncoder_Encode( DoFEncoder encoder, DoFVariables** list, uint8_t* buffer, size_t bufferSize )
+{
+  if( bufferSize < HEADER_SIZE ) return 0;
+  
+  bool isKeyframe = encoder->isKeyframeRequested || ( encoder->keyframeInterval > 0 && encoder->framesCount >= encoder->keyframeInterval );
+  
+  BitStream stream = { .data = buffer + HEADER_SIZE, .size = bufferSize - HEADER_SIZE };
+  for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+  {
+    double precision = encoder->precisionsList[ fieldIndex ];
+    if( precision == 0.0 ) continue;
+    
+    int64_t* newValues = encoder->newValues + fieldIndex * encoder->dofsNumber;
+    int64_t* quantizedValues = encoder->quantizedValues + fieldIndex * encoder->dofsNumber;
+    uint64_t codesMask = 0;
+    for( size_t dofIndex = 0; dofIndex < encoder->dofsNumber; dofIndex++ )
+    {
+      double value;
+      memcpy( &value, (const uint8_t*) list[ dofIndex ] + FIELD_OFFSETS[ fieldIndex ], sizeof(double) );
+      newValues[ dofIndex ] = Quantize( value, precision );
+      // Deltas in modular (unsigned) arithmetic are always defined, and reconstructed exactly by the decoder
+      uint64_t delta = (uint64_t) newValues[ dofIndex ] - ( isKeyframe ? 0 : (uint64_t) quantizedValues[ dofIndex ] );
+      encoder->codesList[ dofIndex ] = EncodeZigZag( (int64_t) delta );
+      codesMask |= encoder->codesList[ dofIndex ];
+    }
+    
+    unsigned int bitWidth = GetBitWidth( codesMask );
+    WriteBits( &stream, bitWidth, WIDTH_BITS );
+    for( size_t dofIndex = 0; dofIndex < encoder->dofsNumber; dofIndex++ )
+      WriteBits( &stream, encoder->codesList[ dofIndex ], bitWidth );
+  }
+  if( stream.isOverflown ) return 0;
+  
+  buffer[ 0 ] = isKeyframe ? FRAME_KEYFRAME : 0;
+  buffer[ 1 ] = (uint8_t) ( encoder->sequence & 0xFF );
+  buffer[ 2 ] = (uint8_t) ( encoder->sequence >> 8 );
+  
+  int64_t* quantizedValues = encoder->quantizedValues;
+  encoder->quantizedValues = encoder->newValues;
+  encoder->newValues = quantizedValues;
+  encoder->sequence++;
+  encoder->framesCount = isKeyframe ? 1 : encoder->framesCount + 1;
+  encoder->isKeyframeRequested = false;
+  
+  return HEADER_SIZE + ( stream.bitPosition + 7 ) / 8;
+}
+
+DoFDecoder DoFDecoder_Create( size_t dofsNumber, const DoFVariables* precision )
+{
+  if( dofsNumber == 0 || precision == NULL ) return NULL;
+  
+  DoFDecoder newDecoder = (DoFDecoder) calloc( 1, sizeof(DoFDecoderData) );
+  if( newDecoder == NULL ) return NULL;
+  
+  newDecoder->dofsNumber = dofsNumber;
+  SetPrecisions( newDecoder->precisionsList, precision );
+  
+  newDecoder->quantizedValues = (int64_t*) calloc( DOF_VARIABLES_NUMBER * dofsNumber, sizeof(int64_t) );
+  newDecoder->newValues = (int64_t*) calloc( DOF_VARIABLES_NUMBER * dofsNumber, sizeof(int64_t) );
+  if( newDecoder->quantizedValues == NULL || newDecoder->newValues == NULL )
+  {
+    DoFDecoder_Discard( newDecoder );
+    return NULL;
+  }
+  
+  return newDecoder;
+}
+
+void DoFDecoder_Discard( DoFDecoder decoder )
+{
+  if( decoder == NULL ) return;
+  
+  free( decoder->quantizedValues );
+  free( decoder->newValues );
+  free( decoder );
+}
+
+bool DoFDecoder_Decode( DoFDecoder decoder, const uint8_t* data, size_t dataSize, DoFVariables** list )
+{
+  if( dataSize < HEADER_SIZE ) return false;
+  
+  bool isKeyframe = ( data[ 0 ] & FRAME_KEYFRAME );
+  uint16_t sequence = (uint16_t) ( data[ 1 ] | ( data[ 2 ] << 8 ) );
+  
+  // Decoder state is only updated after the whole frame is decoded, so that malformed or rejected frames don't change it
+  uint16_t sequenceGap = 0;
+  if( decoder->hasSequence )
+  {
+    sequenceGap = (uint16_t) ( sequence - decoder->sequence - 1 );
+    // Delta frames older than the last one (reordered or duplicated) are ignored, while keyframes always restart the sequence 
+    // (as with encoder restarts or outages longer than half of the sequence range), without counting lost frames
+    if( sequenceGap >= UINT16_MAX / 2 )
+    {
+      if( !isKeyframe ) return false;
+      sequenceGap = 0;
+    }
+    // Deltas are only valid over the immediately preceding frame
+    else if( sequenceGap > 0 && !isKeyframe ) return false;
+  }
+  
+  if( !isKeyframe && !decoder->hasReference ) return false;
+  
+  BitStream stream = { .data = (uint8_t*) data + HEADER_SIZE, .size = dataSize - HEADER_SIZE };
+  for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+  {
+    if( decoder->precisionsList[ fieldIndex ] == 0.0 ) continue;
+    
+    int64_t* newValues = decoder->newValues + fieldIndex * decoder->dofsNumber;
+    int64_t* quantizedValues = decoder->quantizedValues + fieldIndex * decoder->dofsNumber;
+    unsigned int bitWidth = (unsigned int) ReadBits( &stream, WIDTH_BITS );
+    if( bitWidth > 64 ) stream.isOverflown = true;
+    for( size_t dofIndex = 0; dofIndex < decoder->dofsNumber && !stream.isOverflown; dofIndex++ )
+    {
+      uint64_t delta = (uint64_t) DecodeZigZag( ReadBits( &stream, bitWidth ) );
+      newValues[ dofIndex ] = (int64_t) ( delta + ( isKeyframe ? 0 : (uint64_t) quantizedValues[ dofIndex ] ) );
+    }
+  }
+  if( stream.isOverflown ) return false;
+  
+  int64_t* quantizedValues = decoder->newValues;
+  decoder->newValues = decoder->quantizedValues;
+  decoder->quantizedValues = quantizedValues;
+  decoder->hasReference = true;
+  decoder->lostFramesCount += sequenceGap;
+  decoder->sequence = sequence;
+  decoder->hasSequence = true;
+  
+  for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+  {
+    double precision = decoder->precisionsList[ fieldIndex ];
+    if( precision == 0.0 ) continue;
+    
+    for( size_t dofIndex = 0; dofIndex < decoder->dofsNumber; dofIndex++ )
+    {
+      double value = (double) quantizedValues[ fieldIndex * decoder->dofsNumber + dofIndex ] * precision;
+      memcpy( (uint8_t*) list[ dofIndex ] + FIELD_OFFSETS[ fieldIndex ], &value, sizeof(double) );
+    }
+  }
+  
+  return true;
+}
+
+uint64_t DoFDecoder_GetLostFramesCount( DoFDecoder decoder )
+{
+  return decoder->lostFramesCount;
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file dof_codec.h
+/// @brief Lossy compression of per step DoFVariables lists, for telemetry streams over constrained links
+///
+/// Each field is quantized to a configurable precision (with error bounded to half of it, and no drift accumulated over steps), 
+/// and frames carry the differences of quantized values from the previous step, bit-packed with the minimum number of bits for 
+/// each field. Periodic (or requested) keyframes carry absolute values instead, so that a decoder missing a frame (detected from frame 
+/// sequence numbers) resumes decoding at the next keyframe, instead of reconstructing wrong values
+///
+/// Frame layout: | flags (u8) | sequence (u16, little-endian) |, followed by a bit stream (LSB first) of, for each encoded field in 
+/// DoFVariableFlag order, | bit width (7 bits) | zigzag encoded value (delta or absolute) of each DoF, with the given bit width |
+
+#ifndef DOF_CODEC_H
+#define DOF_CODEC_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Opaque encoder data
+typedef struct _DoFEncoderData DoFEncoderData;
+/// Opaque reference to DoF variables encoder
+typedef DoFEncoderData* DoFEncoder;
+
+/// Opaque decoder data
+typedef struct _DoFDecoderData DoFDecoderData;
+/// Opaque reference to DoF variables decoder
+typedef DoFDecoderData* DoFDecoder;
+
+/// @brief Gets maximum size of frames encoded for given number of degrees-of-freedom (size of keyframes of values of all fields)
+/// @param[in] dofsNumber number of degrees-of-freedom in each step
+/// @return frame size upper bound (in bytes)
+size_t DoFCodec_GetMaxFrameSize( size_t dofsNumber );
+
+/// @brief Creates encoder of steps of given number of degrees-of-freedom
+/// @param[in] dofsNumber number of degrees-of-freedom in each step
+/// @param[in] precision quantization step of each field (e.g. 1e-5 rad for position), with fields of zero precision not encoded
+/// @param[in] keyframeInterval number of frames between keyframes (0 for keyframes only at start and when requested)
+/// @return reference to created encoder on success, NULL otherwise
+DoFEncoder DoFEncoder_Create( size_t dofsNumber, const DoFVariables* precision, size_t keyframeInterval );
+
+/// @brief Deallocates data of given encoder
+/// @param[in] encoder reference to DoF variables encoder
+void DoFEncoder_Discard( DoFEncoder encoder );
+
+/// @brief Forces next encoded frame to be a keyframe (e.g. when a receiver reports lost frames)
+/// @param[in] encoder reference to DoF variables encoder
+void DoFEncoder_RequestKeyframe( DoFEncoder encoder );
+
+/// @brief Encodes step variables into a new frame
+/// @param[in] encoder reference to DoF variables encoder
+/// @param[in] list list of per degree-of-freedom variables (values beyond quantization range are saturated, and NaNs taken as 0)
+/// @param[out] buffer frame data destination
+/// @param[in] bufferSize size of destination buffer (DoFCodec_GetMaxFrameSize is always enough)
+/// @return size of encoded frame (in bytes), or 0 if it doesn't fit the buffer (with encoder state unchanged)
+size_t DoFEncoder_Encode( DoFEncoder encoder, DoFVariables** list, uint8_t* buffer, size_t bufferSize );
+
+/// @brief Creates decoder of steps of given number of degrees-of-freedom
+/// @param[in] dofsNumber number of degrees-of-freedom in each step
+/// @param[in] precision quantization step of each field, matching the one of the encoder
+/// @return reference to created decoder on success, NULL otherwise
+DoFDecoder DoFDecoder_Create( size_t dofsNumber, const DoFVariables* precision );
+
+/// @brief Deallocates data of given decoder
+/// @param[in] decoder reference to DoF variables decoder
+void DoFDecoder_Discard( DoFDecoder decoder );
+
+/// @brief Decodes step variables from frame, if it's a keyframe (always accepted, restarting the sequence after encoder restarts or long outages) or follows the last decoded frame
+/// @param[in] decoder reference to DoF variables decoder
+/// @param[in] data frame data
+/// @param[in] dataSize size of frame data (in bytes)
+/// @param[out] list list of per degree-of-freedom variables (only encoded fields are written)
+/// @return true if step was decoded, false otherwise (malformed frame, with decoder state unchanged, or delta frame not following the last decoded one, waiting for a keyframe)
+bool DoFDecoder_Decode( DoFDecoder decoder, const uint8_t* data, size_t dataSize, DoFVariables** list );
+
+/// @brief Gets number of frames missing or not decoded between decoded frames of the same sequence
+/// @param[in] decoder reference to DoF variables decoder
+/// @return number of lost frames
+uint64_t DoFDecoder_GetLostFramesCount( DoFDecoder decoder );
+
+#endif  // DOF_CODEC_H
@@ -0,0 +1,366 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "dof_stream.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PACKET_MAGIC 0x53444352U          // "RCDS"
+#define PACKET_VERSION 2
+
+#define HEADER_SIZE 20
+#define TIMESTAMP_SIZE 8
+#define VALUE_SIZE 8
+
+// Offsets of DoFVariables fields, in DoFVariableFlag bit order
+static const size_t FIELD_OFFSETS[ DOF_VARIABLES_NUMBER ] = { offsetof(DoFVariables, position), offsetof(DoFVariables, velocity), 
+                                                              offsetof(DoFVariables, force), offsetof(DoFVariables, acceleration), 
+                                                              offsetof(DoFVariables, inertia), offsetof(DoFVariables, stiffness), 
+                                                              offsetof(DoFVariables, damping) };
+
+struct _DoFStreamSenderData
+{
+  int socketFD;
+  size_t dofsNumber;
+  DoFChangesMask fieldsMask;
+  size_t stepSize;
+  size_t batchStepsNumber;
+  uint32_t senderID;
+  size_t stepsCount;                      // Steps encoded in current batch
+  uint32_t nextSequence;
+  uint8_t* packet;
+};
+
+struct _DoFStreamReceiverData
+{
+  int socketFD;
+  size_t dofsNumber;
+  DoFChangesMask fieldsMask;
+  size_t stepSize;
+  size_t stepsNumber;                     // Steps in current datagram
+  size_t stepIndex;                       // Next step to be decoded from current datagram
+  uint32_t firstSequence;
+  uint32_t sequence;
+  uint32_t senderID;                      // Sender of the last decoded step, whose sequence new steps follow
+  bool hasSequence;
+  uint64_t lostStepsCount;
+  uint64_t droppedPacketsCount;
+  uint8_t* packet;
+};
+
+
+static size_t GetFieldsNumber( DoFChangesMask fieldsMask )
+{
+  size_t fieldsNumber = 0;
+  for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+    if( fieldsMask & ( 1 << fieldIndex ) ) fieldsNumber++;
+  
+  return fieldsNumber;
+}
+
+static size_t GetStepSize( size_t dofsNumber, DoFChangesMask fieldsMask )
+{
+  return TIMESTAMP_SIZE + dofsNumber * GetFieldsNumber( fieldsMask ) * VALUE_SIZE;
+}
+
+size_t DoFStream_GetPacketSize( size_t dofsNumber, DoFChangesMask fieldsMask, size_t batchStepsNumber )
+{
+  return HEADER_SIZE + batchStepsNumber * GetStepSize( dofsNumber, fieldsMask );
+}
+
+static inline void WriteUInt16( uint8_t* data, uint16_t value ) { value = htole16( value ); memcpy( data, &value, sizeof(value) ); }
+static inline void WriteUInt32( uint8_t* data, uint32_t value ) { value = htole32( value ); memcpy( data, &value, sizeof(value) ); }
+static inline void WriteUInt64( uint8_t* data, uint64_t value ) { value = htole64( value ); memcpy( data, &value, sizeof(value) ); }
+
+static inline uint16_t ReadUInt16( const uint8_t* data ) { uint16_t value; memcpy( &value, data, sizeof(value) ); return le16toh( value ); }
+static inline uint32_t ReadUInt32( const uint8_t* data ) { uint32_t value; memcpy( &value, data, sizeof(value) ); return le32toh( value ); }
+static inline uint64_t ReadUInt64( const uint8_t* data ) { uint64_t value; memcpy( &value, data, sizeof(value) ); return le64toh( value ); }
+
+static int OpenSocket( const char* host, uint16_t port, bool isReceiver )
+{
+  struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM };
+  if( isReceiver ) 
+  {
+    hints.ai_flags = AI_PASSIVE;
+    if( host == NULL ) hints.ai_family = AF_INET;
+  }
+  
+  char portString[ 8 ];
+  snprintf( portString, sizeof(portString), "%u", (unsigned int) port );
+  struct addrinfo* addressesList;
+  if( getaddrinfo( host, portString, &hints, &addressesList ) != 0 ) return -1;
+  
+  int socketFD = -1;
+  for( struct addrinfo* address = addressesList; address != NULL && socketFD == -1; address = address->ai_next )
+  {
+    if( ( socketFD = socket( address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol ) ) == -1 ) continue;
+    // Connected sender socket avoids per datagram address lookup and routing
+    int status = isReceiver ? bind( socketFD, address->ai_addr, address->ai_addrlen ) : connect( socketFD, address->ai_addr, address->ai_addrlen );
+    if( status == -1 )
+    {
+      close( socketFD );
+      socketFD = -1;
+    }
+  }
+  
+  freeaddrinfo( addressesList );
+  
+  return socketFD;
+}
+
+DoFStreamSender DoFStreamSender_Create( const char* host, uint16_t port, size_t dofsNumber, DoFChangesMask fieldsMask, size_t batchStepsNumber )
+{
+  fieldsMask &= DOF_ALL_VARIABLES;
+  if( host == NULL || dofsNumber == 0 || dofsNumber > UINT16_MAX || fieldsMask == 0 || batchStepsNumber == 0 ) return NULL;
+  if( batchStepsNumber > DOF_STREAM_MAX_PACKET_SIZE || DoFStream_GetPacketSize( dofsNumber, fieldsMask, batchStepsNumber ) > DOF_STREAM_MAX_PACKET_SIZE ) 
+    return NULL;
+  
+  DoFStreamSender newSender = (DoFStreamSender) calloc( 1, sizeof(DoFStreamSenderData) );
+  if( newSender == NULL ) return NULL;
+  
+  newSender->dofsNumber = dofsNumber;
+  newSender->fieldsMask = fieldsMask;
+  newSender->stepSize = GetStepSize( dofsNumber, fieldsMask );
+  newSender->batchStepsNumber = batchStepsNumber;
+  
+  newSender->packet = (uint8_t*) calloc( 1, DoFStream_GetPacketSize( dofsNumber, fieldsMask, batchStepsNumber ) );
+  if( newSender->packet == NULL || ( newSender->socketFD = OpenSocket( host, port, false ) ) == -1 )
+  {
+    free( newSender->packet );
+    free( newSender );
+    return NULL;
+  }
+  
+  WriteUInt32( newSender->packet, PACKET_MAGIC );
+  newSender->packet[ 4 ] = PACKET_VERSION;
+  newSender->packet[ 5 ] = fieldsMask;
+  WriteUInt16( newSender->packet + 8, (uint16_t) dofsNumber );
+  // Identifies sequence of this sender, so that receivers don't drop steps of a restarted one as stale. Random 32 bits make it 
+  // unlikely for a restarted sender to reuse the previous ID (falling back to time and process mixing if no entropy is available)
+  if( getrandom( &(newSender->senderID), sizeof(newSender->senderID), GRND_NONBLOCK ) != (ssize_t) sizeof(newSender->senderID) )
+  {
+    struct timespec currentTime;
+    clock_gettime( CLOCK_REALTIME, &currentTime );
+    newSender->senderID = (uint32_t) ( ( (uint64_t) getpid() << 16 ) ^ (uint64_t) currentTime.tv_nsec ^ (uint64_t) currentTime.tv_sec ^ (uintptr_t) newSender );
+  }
+  WriteUInt32( newSender->packet + 12, newSender->senderID );
+  
+  return newSender;
+}
+
+void DoFStreamSender_Discard( DoFStreamSender sender )
+{
+  if( sender == NULL ) return;
+  
+  close( sender->socketFD );
+  free( sender->packet );
+  free( sender );
+}
+
+bool DoFStreamSender_AddStep( DoFStreamSender sender, DoFVariables** list, uint64_t timestamp )
+{
+  uint8_t* data = sender->packet + HEADER_SIZE + sender->stepsCount * sender->stepSize;
+  
+  WriteUInt64( data, timestamp );
+  data += TIMESTAMP_SIZE;
+  for( size_t dofIndex = 0; dofIndex < sender->dofsNumber; dofIndex++ )
+  {
+    const uint8_t* variables = (const uint8_t*) list[ dofIndex ];
+    for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+    {
+      if( !( sender->fieldsMask & ( 1 << fieldIndex ) ) ) continue;
+      uint64_t value;
+      memcpy( &value, variables + FIELD_OFFSETS[ fieldIndex ], VALUE_SIZE );
+      WriteUInt64( data, value );
+      data += VALUE_SIZE;
+    }
+  }
+  
+  if( ++(sender->stepsCount) < sender->batchStepsNumber ) return true;
+  
+  return DoFStreamSender_Flush( sender );
+}
+
+bool DoFStreamSender_Flush( DoFStreamSender sender )
+{
+  if( sender->stepsCount == 0 ) return true;
+  
+  WriteUInt16( sender->packet + 6, (uint16_t) sender->stepsCount );
+  WriteUInt32( sender->packet + 16, sender->nextSequence );
+  size_t packetSize = HEADER_SIZE + sender->stepsCount * sender->stepSize;
+  
+  // Steps are consumed even if sending fails: the receiver accounts for them as lost, from the sequence gap
+  sender->nextSequence += (uint32_t) sender->stepsCount;
+  sender->stepsCount = 0;
+  
+  return ( send( sender->socketFD, sender->packet, packetSize, MSG_DONTWAIT ) == (ssize_t) packetSize );
+}
+
+DoFStreamReceiver DoFStreamReceiver_Create( const char* address, uint16_t port, size_t dofsNumber )
+{
+  if( dofsNumber == 0 || dofsNumber > UINT16_MAX ) return NULL;
+  
+  DoFStreamReceiver newReceiver = (DoFStreamReceiver) calloc( 1, sizeof(DoFStreamReceiverData) );
+  if( newReceiver == NULL ) return NULL;
+  
+  newReceiver->dofsNumber = dofsNumber;
+  
+  newReceiver->packet = (uint8_t*) malloc( DOF_STREAM_MAX_PACKET_SIZE );
+  if( newReceiver->packet == NULL || ( newReceiver->socketFD = OpenSocket( address, port, true ) ) == -1 )
+  {
+    free( newReceiver->packet );
+    free( newReceiver );
+    return NULL;
+  }
+  
+  return newReceiver;
+}
+
+void DoFStreamReceiver_Discard( DoFStreamReceiver receiver )
+{
+  if( receiver == NULL ) return;
+  
+  close( receiver->socketFD );
+  free( receiver->packet );
+  free( receiver );
+}
+
+uint16_t DoFStreamReceiver_GetPort( DoFStreamReceiver receiver )
+{
+  struct sockaddr_storage address;
+  socklen_t addressLength = sizeof(address);
+  if( getsockname( receiver->socketFD, (struct sockaddr*) &address, &addressLength ) == -1 ) return 0;
+  
+  if( address.ss_family == AF_INET6 ) return ntohs( ((struct sockaddr_in6*) &address)->sin6_port );
+  
+  return ntohs( ((struct sockaddr_in*) &address)->sin_port );
+}
+
+// Reads datagrams until one with steps newer than the last decoded one arrives, or no more are available
+static bool ReceivePacket( DoFStreamReceiver receiver )
+{
+  while( true )
+  {
+    ssize_t packetSize = recv( receiver->socketFD, receiver->packet, DOF_STREAM_MAX_PACKET_SIZE, MSG_DONTWAIT );
+    if( packetSize == -1 )
+    {
+      if( errno == EINTR ) continue;
+      return false;
+    }
+    
+    if( packetSize < HEADER_SIZE || ReadUInt32( receiver->packet ) != PACKET_MAGIC || receiver->packet[ 4 ] != PACKET_VERSION 
+        || ReadUInt16( receiver->packet + 8 ) != receiver->dofsNumber )
+    {
+      receiver->droppedPacketsCount++;
+      continue;
+    }
+    
+    DoFChangesMask fieldsMask = receiver->packet[ 5 ] & DOF_ALL_VARIABLES;
+    size_t stepsNumber = ReadUInt16( receiver->packet + 6 );
+    size_t stepSize = GetStepSize( receiver->dofsNumber, fieldsMask );
+    uint32_t firstSequence = ReadUInt32( receiver->packet + 16 );
+    uint32_t lastSequence = firstSequence + (uint32_t) stepsNumber - 1;
+    // Steps of a different sender start a new sequence
+    uint32_t senderID = ReadUInt32( receiver->packet + 12 );
+    bool isSequenceKept = ( receiver->hasSequence && senderID == receiver->senderID );
+    if( stepsNumber == 0 || (size_t) packetSize != HEADER_SIZE + stepsNumber * stepSize 
+        || ( isSequenceKept && (int32_t) ( lastSequence - receiver->sequence ) <= 0 ) )
+    {
+      receiver->droppedPacketsCount++;
+      continue;
+    }
+    
+    receiver->fieldsMask = fieldsMask;
+    receiver->stepSize = stepSize;
+    receiver->stepsNumber = stepsNumber;
+    receiver->firstSequence = firstSequence;
+    receiver->senderID = senderID;
+    receiver->hasSequence = isSequenceKept;
+    // Skips steps of the batch already decoded from a previous (duplicated or overlapping) datagram
+    receiver->stepIndex = 0;
+    if( isSequenceKept && (int32_t) ( firstSequence - receiver->sequence ) <= 0 ) 
+      receiver->stepIndex = receiver->sequence - firstSequence + 1;
+    
+    return true;
+  }
+}
+
+bool DoFStreamReceiver_ReceiveStep( DoFStreamReceiver receiver, DoFVariables** list, uint64_t* timestamp )
+{
+  if( receiver->stepIndex >= receiver->stepsNumber ) 
+  {
+    if( !ReceivePacket( receiver ) ) return false;
+  }
+  
+  uint32_t sequence = receiver->firstSequence + (uint32_t) receiver->stepIndex;
+  if( receiver->hasSequence ) receiver->lostStepsCount += sequence - receiver->sequence - 1;
+  receiver->sequence = sequence;
+  receiver->hasSequence = true;
+  
+  const uint8_t* data = receiver->packet + HEADER_SIZE + receiver->stepIndex * receiver->stepSize;
+  receiver->stepIndex++;
+  
+  if( timestamp != NULL ) *timestamp = ReadUInt64( data );
+  data += TIMESTAMP_SIZE;
+  for( size_t dofIndex = 0; dofIndex < receiver->dofsNumber; dofIndex++ )
+  {
+    uint8_t* variables = (uint8_t*) list[ dofIndex ];
+    for( size_t fieldIndex = 0; fieldIndex < DOF_VARIABLES_NUMBER; fieldIndex++ )
+    {
+      if( !( receiver->fieldsMask & ( 1 << fieldIndex ) ) ) continue;
+      uint64_t value = ReadUInt64( data );
+      memcpy( variables + FIELD_OFFSETS[ fieldIndex ], &value, VALUE_SIZE );
+      data += VALUE_SIZE;
+    }
+  }
+  
+  return true;
+}
+
+uint32_t DoFStreamReceiver_GetSequence( DoFStreamReceiver receiver )
+{
+  return receiver->sequence;
+}
+
+DoFChangesMask DoFStreamReceiver_GetFieldsMask( DoFStreamReceiver receiver )
+{
+  return receiver->fieldsMask;
+}
+
+uint64_t DoFStreamReceiver_GetLostStepsCount( DoFStreamReceiver receiver )
+{
+  return receiver->lostStepsCount;
+}
+
+uint64_t DoFStreamReceiver_GetDroppedPacketsCount( DoFStreamReceiver receiver )
+{
+  return receiver->droppedPacketsCount;
+}
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file dof_stream.h
+/// @brief Compact binary UDP streaming of robot setpoints/measures between hosts (e.g. remote planner and control process)
+///
+/// Each datagram carries selected DoFVariables fields (DoFVariableFlag mask) of all joints or axes, for a batch of consecutive control steps, 
+/// each one with its sequence number and timestamp. Values are encoded as little-endian IEEE 754 doubles, so that no text parsing is 
+/// needed, and there is no connection, retransmission or ordering delay: receivers detect lost steps from sequence gaps and drop 
+/// stale (reordered or duplicated) ones, restarting the sequence when datagrams from a new sender (e.g. restarted planner) arrive
+///
+/// Datagram layout (little-endian): 
+/// | magic (u32) | version (u8) | fields mask (u8) | steps number (u16) | DoFs number (u16) | reserved (u16, zero) | sender ID (u32) | first step sequence (u32) |, 
+/// followed, for each step, by | timestamp (u64) | selected fields of first DoF | selected fields of second DoF | ... |
+
+#ifndef DOF_STREAM_H
+#define DOF_STREAM_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DOF_STREAM_MAX_PACKET_SIZE 65507    ///< Maximum size (in bytes) of stream datagrams (UDP over IPv4 limit)
+
+/// Opaque stream sender data
+typedef struct _DoFStreamSenderData DoFStreamSenderData;
+/// Opaque reference to stream sender
+typedef DoFStreamSenderData* DoFStreamSender;
+
+/// Opaque stream receiver data
+typedef struct _DoFStreamReceiverData DoFStreamReceiverData;
+/// Opaque reference to stream receiver
+typedef DoFStreamReceiverData* DoFStreamReceiver;
+
+/// @brief Gets size of datagrams sent for given stream configuration (useful for keeping them below network MTU)
+/// @param[in] dofsNumber number of degrees-of-freedom in each step
+/// @param[in] fieldsMask set of DoFVariableFlag values of sent fields
+/// @param[in] batchStepsNumber number of steps in each datagram
+/// @return datagram size (in bytes)
+size_t DoFStream_GetPacketSize( size_t dofsNumber, DoFChangesMask fieldsMask, size_t batchStepsNumber );
+
+/// @brief Creates stream sender to given remote address
+/// @param[in] host remote host name or IPv4/IPv6 address
+/// @param[in] port remote UDP port
+/// @param[in] dofsNumber number of degrees-of-freedom in each step
+/// @param[in] fieldsMask set of DoFVariableFlag values of sent fields (e.g. DOF_POSITION | DOF_VELOCITY)
+/// @param[in] batchStepsNumber number of steps sent together in each datagram (1 for sending every step immediately)
+/// @return reference to created sender on success, NULL otherwise (e.g. unresolved host or datagram larger than DOF_STREAM_MAX_PACKET_SIZE)
+DoFStreamSender DoFStreamSender_Create( const char* host, uint16_t port, size_t dofsNumber, DoFChangesMask fieldsMask, size_t batchStepsNumber );
+
+/// @brief Closes socket and deallocates data of given stream sender (pending batch steps are not sent)
+/// @param[in] sender reference to stream sender
+void DoFStreamSender_Discard( DoFStreamSender sender );
+
+/// @brief Encodes step variables into current batch, sending the datagram (without blocking) when the batch is complete
+/// @param[in] sender reference to stream sender
+/// @param[in] list list of per degree-of-freedom variables (only fields selected on creation are sent)
+/// @param[in] timestamp step time, in caller defined units (e.g. nanoseconds of CLOCK_MONOTONIC or control step index)
+/// @return false if sending the complete batch failed, true otherwise
+bool DoFStreamSender_AddStep( DoFStreamSender sender, DoFVariables** list, uint64_t timestamp );
+
+/// @brief Sends current incomplete batch, if any (without blocking)
+/// @param[in] sender reference to stream sender
+/// @return false if sending failed, true otherwise
+bool DoFStreamSender_Flush( DoFStreamSender sender );
+
+/// @brief Creates stream receiver bound to given local address
+/// @param[in] address local IPv4/IPv6 address (e.g. "127.0.0.1"), or NULL for any IPv4 address
+/// @param[in] port local UDP port, or 0 for an ephemeral one (see DoFStreamReceiver_GetPort)
+/// @param[in] dofsNumber number of degrees-of-freedom in each step (datagrams with different sizes are dropped)
+/// @return reference to created receiver on success, NULL otherwise
+DoFStreamReceiver DoFStreamReceiver_Create( const char* address, uint16_t port, size_t dofsNumber );
+
+/// @brief Closes socket and deallocates data of given stream receiver
+/// @param[in] receiver reference to stream receiver
+void DoFStreamReceiver_Discard( DoFStreamReceiver receiver );
+
+/// @brief Gets local UDP port of stream receiver
+/// @param[in] receiver reference to stream receiver
+/// @return bound port number
+uint16_t DoFStreamReceiver_GetPort( DoFStreamReceiver receiver );
+
+/// @brief Decodes next received step, from the last datagram batch or a new one (without blocking), skipping stale steps
+/// @param[in] receiver reference to stream receiver
+/// @param[out] list list of per degree-of-freedom variables (only fields present in the datagram are written)
+/// @param[out] timestamp sender defined step time (may be NULL)
+/// @return true if a step was decoded, false if no new steps were available
+bool DoFStreamReceiver_ReceiveStep( DoFStreamReceiver receiver, DoFVariables** list, uint64_t* timestamp );
+
+/// @brief Gets sequence number of the last step decoded by stream receiver
+/// @param[in] receiver reference to stream receiver
+/// @return step sequence number (counted by sender from 0)
+uint32_t DoFStreamReceiver_GetSequence( DoFStreamReceiver receiver );
+
+/// @brief Gets set of fields present in the last step decoded by stream receiver
+/// @param[in] receiver reference to stream receiver
+/// @return set of DoFVariableFlag values of written fields
+DoFChangesMask DoFStreamReceiver_GetFieldsMask( DoFStreamReceiver receiver );
+
+/// @brief Gets number of steps missing in sequence of stream receiver (lost or arrived after later ones)
+/// @param[in] receiver reference to stream receiver
+/// @return number of lost steps
+uint64_t DoFStreamReceiver_GetLostStepsCount( DoFStreamReceiver receiver );
+
+/// @brief Gets number of received datagrams dropped by stream receiver for being malformed, incompatible or carrying only stale steps
+/// @param[in] receiver reference to stream receiver
+/// @return number of dropped datagrams
+uint64_t DoFStreamReceiver_GetDroppedPacketsCount( DoFStreamReceiver receiver );
+
+#endif  // DOF_STREAM_H
@@ -0,0 +1,528 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "fleet_executor.h"
+#include "rt_guard.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSECS_PER_SEC 1000000000LL
+
+#define DEFAULT_STEAL_DELAY 50e-6
+#define MAX_IDLE_TIME_NS ( NSECS_PER_SEC / 10 )
+
+// Real-time safety guard functions are only defined when the RobotControlGuard debug library is linked or preloaded
+#pragma weak RTGuard_PrepareThread
+#pragma weak RTGuard_EnterStep
+#pragma weak RTGuard_ExitStep
+
+static inline void PrepareGuardedThread( void )
+{
+  if( RTGuard_PrepareThread != NULL ) RTGuard_PrepareThread( 0 );
+}
+
+static inline void EnterGuardedStep( void )
+{
+  if( RTGuard_EnterStep != NULL ) RTGuard_EnterStep();
+}
+
+static inline void ExitGuardedStep( void )
+{
+  if( RTGuard_ExitStep != NULL ) RTGuard_ExitStep();
+}
+
+typedef struct _WorkerData WorkerData;
+
+typedef struct Robot
+{
+  int64_t periodNs;
+  ControlStepFunction runStep;
+  void* stepData;
+  size_t ownerIndex;
+  double stepsRate;
+  int64_t releaseTimeNs, lastStepTimeNs;  // Only accessed by the worker holding the robot
+  atomic_uint_fast64_t stepsCount, deadlineMissesCount;
+  _Atomic double lastTimeDelta, maxReleaseLatency, maxStepDuration;
+}
+Robot;
+
+struct _WorkerData
+{
+  FleetExecutor executor;
+  size_t index;
+  pthread_t thread;
+  bool hasThread;
+  pthread_mutex_t lock;
+  pthread_cond_t wakeupSignal;            // Signalled when robots returned by other workers (or executor stop) change the next release time
+  atomic_uint_fast64_t wakeupsCount;      // Only incremented while holding the lock, so that idle waits don't miss signals
+  Robot** releaseHeap;                    // Robots owned by worker and not being run, ordered by release time
+  size_t releaseHeapSize, robotsNumber;
+  atomic_int cpu, threadID;
+  atomic_uint_fast64_t stepsCount, stolenStepsCount, migrationsCount;
+  atomic_int_fast64_t busyTimeNs;
+};
+
+struct _FleetExecutorData
+{
+  FleetExecutorSettings settings;
+  int64_t stealDelayNs;
+  Robot* robotsList;
+  size_t robotsNumber;
+  WorkerData* workersList;
+  size_t workersNumber;
+  bool isStarted;
+  int64_t startTimeNs;
+  atomic_bool isRunning;
+  sem_t placementSignal;
+  atomic_bool isPlacementFailed;
+};
+
+
+static inline int64_t GetCurrentTimeNs( void )
+{
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return (int64_t) now.tv_sec * NSECS_PER_SEC + now.tv_nsec;
+}
+
+static void PushRobot( WorkerData* worker, Robot* robot )
+{
+  size_t index = worker->releaseHeapSize++;
+  while( index > 0 )
+  {
+    size_t parentIndex = ( index - 1 ) / 2;
+    if( worker->releaseHeap[ parentIndex ]->releaseTimeNs <= robot->releaseTimeNs ) break;
+    worker->releaseHeap[ index ] = worker->releaseHeap[ parentIndex ];
+    index = parentIndex;
+  }
+  worker->releaseHeap[ index ] = robot;
+}
+
+static Robot* PopRobot( WorkerData* worker )
+{
+  Robot* firstRobot = worker->releaseHeap[ 0 ];
+  Robot* lastRobot = worker->releaseHeap[ --worker->releaseHeapSize ];
+  size_t index = 0;
+  while( 2 * index + 1 < worker->releaseHeapSize )
+  {
+    size_t childIndex = 2 * index + 1;
+    if( childIndex + 1 < worker->releaseHeapSize && worker->releaseHeap[ childIndex + 1 ]->releaseTimeNs < worker->releaseHeap[ childIndex ]->releaseTimeNs ) childIndex++;
+    if( lastRobot->releaseTimeNs <= worker->releaseHeap[ childIndex ]->releaseTimeNs ) break;
+    worker->releaseHeap[ index ] = worker->releaseHeap[ childIndex ];
+    index = childIndex;
+  }
+  worker->releaseHeap[ index ] = lastRobot;
+  
+  return firstRobot;
+}
+
+// Takes the earliest released robot of worker, if it was released at least releaseDelayNs ago
+static Robot* TakeReleasedRobot( WorkerData* worker, int64_t timeNs, int64_t releaseDelayNs )
+{
+  Robot* robot = NULL;
+  pthread_mutex_lock( &(worker->lock) );
+  if( worker->releaseHeapSize > 0 && worker->releaseHeap[ 0 ]->releaseTimeNs + releaseDelayNs <= timeNs ) robot = PopRobot( worker );
+  pthread_mutex_unlock( &(worker->lock) );
+  
+  return robot;
+}
+
+static void WakeWorker( WorkerData* worker )
+{
+  atomic_fetch_add_explicit( &(worker->wakeupsCount), 1, memory_order_relaxed );
+  pthread_cond_signal( &(worker->wakeupSignal) );
+}
+
+static int64_t GetNextReleaseTime( WorkerData* worker, int64_t releaseDelayNs, int64_t maxTimeNs )
+{
+  pthread_mutex_lock( &(worker->lock) );
+  if( worker->releaseHeapSize > 0 && worker->releaseHeap[ 0 ]->releaseTimeNs + releaseDelayNs < maxTimeNs ) 
+    maxTimeNs = worker->releaseHeap[ 0 ]->releaseTimeNs + releaseDelayNs;
+  pthread_mutex_unlock( &(worker->lock) );
+  
+  return maxTimeNs;
+}
+
+static void RunRobotStep( WorkerData* worker, Robot* robot )
+{
+  FleetExecutor executor = worker->executor;
+  
+  int64_t stepTimeNs = GetCurrentTimeNs();
+  double timeDelta = (double) ( stepTimeNs - robot->lastStepTimeNs ) / NSECS_PER_SEC;
+  robot->lastStepTimeNs = stepTimeNs;
+  
+  EnterGuardedStep();
+  robot->runStep( robot->stepData, timeDelta );
+  ExitGuardedStep();
+  
+  int64_t stepEndTimeNs = GetCurrentTimeNs();
+  
+  double releaseLatency = (double) ( stepTimeNs - robot->releaseTimeNs ) / NSECS_PER_SEC;
+  double stepDuration = (double) ( stepEndTimeNs - stepTimeNs ) / NSECS_PER_SEC;
+  atomic_store_explicit( &(robot->lastTimeDelta), timeDelta, memory_order_relaxed );
+  if( releaseLatency > atomic_load_explicit( &(robot->maxReleaseLatency), memory_order_relaxed ) )
+    atomic_store_explicit( &(robot->maxReleaseLatency), releaseLatency, memory_order_relaxed );
+  if( stepDuration > atomic_load_explicit( &(robot->maxStepDuration), memory_order_relaxed ) )
+    atomic_store_explicit( &(robot->maxStepDuration), stepDuration, memory_order_relaxed );
+  atomic_fetch_add_explicit( &(robot->stepsCount), 1, memory_order_release );
+  
+  int cpu = sched_getcpu();
+  int lastCPU = atomic_load_explicit( &(worker->cpu), memory_order_relaxed );
+  if( cpu != lastCPU )
+  {
+    if( lastCPU >= 0 ) atomic_fetch_add_explicit( &(worker->migrationsCount), 1, memory_order_relaxed );
+    atomic_store_explicit( &(worker->cpu), cpu, memory_order_relaxed );
+  }
+  atomic_fetch_add_explicit( &(worker->busyTimeNs), stepEndTimeNs - stepTimeNs, memory_order_relaxed );
+  atomic_fetch_add_explicit( &(worker->stepsCount), 1, memory_order_relaxed );
+  if( robot->ownerIndex != worker->index ) atomic_fetch_add_explicit( &(worker->stolenStepsCount), 1, memory_order_relaxed );
+  
+  // Same policy as control loops: steps ending after the next release time miss it, and following releases are realigned
+  robot->releaseTimeNs += robot->periodNs;
+  if( stepEndTimeNs > robot->releaseTimeNs )
+  {
+    atomic_fetch_add_explicit( &(robot->deadlineMissesCount), 1, memory_order_relaxed );
+    robot->releaseTimeNs = stepEndTimeNs + robot->periodNs;
+  }
+  
+  // Owner may be idle, waiting for the release of a robot after this one
+  WorkerData* owner = &(executor->workersList[ robot->ownerIndex ]);
+  pthread_mutex_lock( &(owner->lock) );
+  PushRobot( owner, robot );
+  if( owner != worker && owner->releaseHeap[ 0 ] == robot ) WakeWorker( owner );
+  pthread_mutex_unlock( &(owner->lock) );
+}
+
+static void* RunWorker( void* data )
+{
+  WorkerData* worker = (WorkerData*) data;
+  FleetExecutor executor = worker->executor;
+  
+  // CPU affinity is set on thread creation. Placement result is reported before running any step
+  bool isPlaced = true;
+  if( executor->settings.placement != NULL )
+  {
+    ControlPlacement memoryPlacement = { .cpusList = NULL, .isMemoryBound = executor->settings.placement->isMemoryBound, 
+                                         .memoryNode = executor->settings.placement->memoryNode };
+    isPlaced = ControlPlacement_ApplyToThread( &memoryPlacement );
+  }
+  if( !isPlaced ) atomic_store( &(executor->isPlacementFailed), true );
+  sem_post( &(executor->placementSignal) );
+  if( !isPlaced ) return NULL;
+  PrepareGuardedThread();
+  atomic_store_explicit( &(worker->threadID), ControlPlacement_GetThreadID(), memory_order_relaxed );
+  
+  while( atomic_load_explicit( &(executor->isRunning), memory_order_relaxed ) )
+  {
+    // Taken before checking own robots, so that robots returned afterwards interrupt the idle wait
+    uint64_t wakeupsCount = atomic_load_explicit( &(worker->wakeupsCount), memory_order_relaxed );
+    int64_t timeNs = GetCurrentTimeNs();
+    
+    // Own robots first, then robots left waiting by busy workers
+    Robot* robot = TakeReleasedRobot( worker, timeNs, 0 );
+    for( size_t offset = 1; offset < executor->workersNumber && robot == NULL; offset++ )
+    {
+      WorkerData* victim = &(executor->workersList[ ( worker->index + offset ) % executor->workersNumber ]);
+      robot = TakeReleasedRobot( victim, timeNs, executor->stealDelayNs );
+    }
+    
+    if( robot != NULL )
+    {
+      RunRobotStep( worker, robot );
+      continue;
+    }
+    
+    int64_t wakeupTimeNs = GetNextReleaseTime( worker, 0, timeNs + MAX_IDLE_TIME_NS );
+    for( size_t victimIndex = 0; victimIndex < executor->workersNumber; victimIndex++ )
+    {
+      if( victimIndex != worker->index ) 
+        wakeupTimeNs = GetNextReleaseTime( &(executor->workersList[ victimIndex ]), executor->stealDelayNs, wakeupTimeNs );
+    }
+    struct timespec wakeupTime = { .tv_sec = wakeupTimeNs / NSECS_PER_SEC, .tv_nsec = wakeupTimeNs % NSECS_PER_SEC };
+    pthread_mutex_lock( &(worker->lock) );
+    int waitResult = 0;
+    while( waitResult != ETIMEDOUT && atomic_load_explicit( &(worker->wakeupsCount), memory_order_relaxed ) == wakeupsCount )
+      waitResult = pthread_cond_timedwait( &(worker->wakeupSignal), &(worker->lock), &wakeupTime );
+    pthread_mutex_unlock( &(worker->lock) );
+  }
+  
+  return NULL;
+}
+
+static bool StartWorkerThread( WorkerData* worker, int priority, const cpu_set_t* cpuSet )
+{
+  pthread_attr_t threadAttributes;
+  pthread_attr_init( &threadAttributes );
+  if( priority > 0 )
+  {
+    struct sched_param schedulingParameters = { .sched_priority = priority };
+    pthread_attr_setinheritsched( &threadAttributes, PTHREAD_EXPLICIT_SCHED );
+    pthread_attr_setschedpolicy( &threadAttributes, SCHED_FIFO );
+    pthread_attr_setschedparam( &threadAttributes, &schedulingParameters );
+  }
+  if( cpuSet != NULL ) pthread_attr_setaffinity_np( &threadAttributes, sizeof(cpu_set_t), cpuSet );
+  
+  int result = pthread_create( &(worker->thread), &threadAttributes, RunWorker, worker );
+  pthread_attr_destroy( &threadAttributes );
+  
+  return ( result == 0 );
+}
+
+FleetExecutor FleetExecutor_Create( const FleetExecutorSettings* settings )
+{
+  if( settings == NULL ) return NULL;
+  if( settings->priority < 0 || settings->stealDelay < 0.0 ) return NULL;
+  
+  FleetExecutor newExecutor = (FleetExecutor) calloc( 1, sizeof(FleetExecutorData) );
+  if( newExecutor == NULL ) return NULL;
+  
+  newExecutor->settings = *settings;
+  newExecutor->stealDelayNs = (int64_t) ( ( settings->stealDelay > 0.0 ? settings->stealDelay : DEFAULT_STEAL_DELAY ) * NSECS_PER_SEC );
+  atomic_init( &(newExecutor->isRunning), false );
+  atomic_init( &(newExecutor->isPlacementFailed), false );
+  sem_init( &(newExecutor->placementSignal), 0, 0 );
+  
+  return newExecutor;
+}
+
+int FleetExecutor_AddRobot( FleetExecutor executor, double stepPeriod, ControlStepFunction runStep, void* stepData )
+{
+  if( executor->isStarted ) return -1;
+  if( stepPeriod <= 0.0 || runStep == NULL ) return -1;
+  
+  Robot* robotsList = (Robot*) realloc( executor->robotsList, ( executor->robotsNumber + 1 ) * sizeof(Robot) );
+  if( robotsList == NULL ) return -1;
+  executor->robotsList = robotsList;
+  
+  Robot* robot = &(executor->robotsList[ executor->robotsNumber ]);
+  robot->periodNs = (int64_t) ( stepPeriod * NSECS_PER_SEC );
+  robot->stepsRate = 1.0 / stepPeriod;
+  robot->runStep = runStep;
+  robot->stepData = stepData;
+  atomic_init( &(robot->stepsCount), 0 );
+  atomic_init( &(robot->deadlineMissesCount), 0 );
+  atomic_init( &(robot->lastTimeDelta), 0.0 );
+  atomic_init( &(robot->maxReleaseLatency), 0.0 );
+  atomic_init( &(robot->maxStepDuration), 0.0 );
+  
+  return (int) executor->robotsNumber++;
+}
+
+bool FleetExecutor_Start( FleetExecutor executor )
+{
+  if( executor->isStarted || executor->robotsNumber == 0 ) return false;
+  
+  const ControlPlacement* placement = executor->settings.placement;
+  if( placement != NULL && ( ControlPlacement_Validate( placement ) & PLACEMENT_ERRORS ) ) return false;
+  
+  cpu_set_t availableCPUs;
+  CPU_ZERO( &availableCPUs );
+  if( placement != NULL && placement->cpusList != NULL )
+  {
+    for( size_t cpuIndex = 0; cpuIndex < placement->cpusNumber; cpuIndex++ )
+      CPU_SET( placement->cpusList[ cpuIndex ], &availableCPUs );
+  }
+  else if( sched_getaffinity( 0, sizeof(cpu_set_t), &availableCPUs ) != 0 ) CPU_SET( 0, &availableCPUs );
+  
+  executor->workersNumber = executor->settings.workersNumber;
+  if( executor->workersNumber == 0 ) executor->workersNumber = (size_t) CPU_COUNT( &availableCPUs );
+  executor->workersList = (WorkerData*) calloc( executor->workersNumber, sizeof(WorkerData) );
+  if( executor->workersList == NULL ) 
+  {
+    executor->workersNumber = 0;
+    return false;
+  }
+  executor->isStarted = true;
+  for( size_t workerIndex = 0; workerIndex < executor->workersNumber; workerIndex++ )
+  {
+    WorkerData* worker = &(executor->workersList[ workerIndex ]);
+    worker->executor = executor;
+    worker->index = workerIndex;
+    pthread_mutex_init( &(worker->lock), NULL );
+    pthread_condattr_t signalAttributes;
+    pthread_condattr_init( &signalAttributes );
+    pthread_condattr_setclock( &signalAttributes, CLOCK_MONOTONIC );
+    pthread_cond_init( &(worker->wakeupSignal), &signalAttributes );
+    pthread_condattr_destroy( &signalAttributes );
+    atomic_init( &(worker->wakeupsCount), 0 );
+    atomic_init( &(worker->cpu), -1 );
+    atomic_init( &(worker->threadID), 0 );
+    atomic_init( &(worker->migrationsCount), 0 );
+    atomic_init( &(worker->stepsCount), 0 );
+    atomic_init( &(worker->stolenStepsCount), 0 );
+    atomic_init( &(worker->busyTimeNs), 0 );
+  }
+  
+  // Robots are assigned to the worker with the lowest step rate sum, from the fastest one
+  double* workerStepsRatesList = (double*) calloc( executor->workersNumber, sizeof(double) );
+  Robot** robotsOrderList = (Robot**) calloc( executor->robotsNumber, sizeof(Robot*) );
+  if( workerStepsRatesList == NULL || robotsOrderList == NULL )
+  {
+    free( workerStepsRatesList );
+    free( robotsOrderList );
+    return false;
+  }
+  for( size_t robotIndex = 0; robotIndex < executor->robotsNumber; robotIndex++ )
+  {
+    size_t orderIndex = robotIndex;
+    for( ; orderIndex > 0 && robotsOrderList[ orderIndex - 1 ]->stepsRate < executor->robotsList[ robotIndex ].stepsRate; orderIndex-- )
+      robotsOrderList[ orderIndex ] = robotsOrderList[ orderIndex - 1 ];
+    robotsOrderList[ orderIndex ] = &(executor->robotsList[ robotIndex ]);
+  }
+  for( size_t orderIndex = 0; orderIndex < executor->robotsNumber; orderIndex++ )
+  {
+    Robot* robot = robotsOrderList[ orderIndex ];
+    robot->ownerIndex = 0;
+    for( size_t workerIndex = 1; workerIndex < executor->workersNumber; workerIndex++ )
+    {
+      if( workerStepsRatesList[ workerIndex ] < workerStepsRatesList[ robot->ownerIndex ] ) robot->ownerIndex = workerIndex;
+    }
+    workerStepsRatesList[ robot->ownerIndex ] += robot->stepsRate;
+    executor->workersList[ robot->ownerIndex ].robotsNumber++;
+  }
+  free( workerStepsRatesList );
+  free( robotsOrderList );
+  
+  for( size_t workerIndex = 0; workerIndex < executor->workersNumber; workerIndex++ )
+  {
+    WorkerData* worker = &(executor->workersList[ workerIndex ]);
+    worker->releaseHeap = (Robot**) calloc( worker->robotsNumber + 1, sizeof(Robot*) );
+    if( worker->releaseHeap == NULL ) return false;
+  }
+  
+  executor->startTimeNs = GetCurrentTimeNs();
+  for( size_t robotIndex = 0; robotIndex < executor->robotsNumber; robotIndex++ )
+  {
+    Robot* robot = &(executor->robotsList[ robotIndex ]);
+    robot->releaseTimeNs = executor->startTimeNs;
+    robot->lastStepTimeNs = executor->startTimeNs - robot->periodNs;
+    PushRobot( &(executor->workersList[ robot->ownerIndex ]), robot );
+  }
+  
+  atomic_store( &(executor->isRunning), true );
+  bool isPlacementRestricted = ( placement != NULL && placement->cpusList != NULL );
+  int cpu = -1;
+  for( size_t workerIndex = 0; workerIndex < executor->workersNumber; workerIndex++ )
+  {
+    cpu_set_t workerCPUs = availableCPUs;
+    if( executor->settings.pinWorkers )
+    {
+      // Wraps around available CPUs when there are more workers than them
+      do { cpu = ( cpu + 1 ) % CPU_SETSIZE; } while( !CPU_ISSET( cpu, &availableCPUs ) );
+      CPU_ZERO( &workerCPUs );
+      CPU_SET( cpu, &workerCPUs );
+    }
+    WorkerData* worker = &(executor->workersList[ workerIndex ]);
+    worker->hasThread = StartWorkerThread( worker, executor->settings.priority, 
+                                           ( executor->settings.pinWorkers || isPlacementRestricted ) ? &workerCPUs : NULL );
+    if( worker->hasThread )
+    {
+      while( sem_wait( &(executor->placementSignal) ) == -1 && errno == EINTR );
+    }
+    if( !worker->hasThread || atomic_load( &(executor->isPlacementFailed) ) )
+    {
+      atomic_store( &(executor->isRunning), false );
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+void FleetExecutor_Discard( FleetExecutor executor )
+{
+  if( executor == NULL ) return;
+  
+  atomic_store( &(executor->isRunning), false );
+  for( size_t workerIndex = 0; workerIndex < executor->workersNumber; workerIndex++ )
+  {
+    WorkerData* worker = &(executor->workersList[ workerIndex ]);
+    pthread_mutex_lock( &(worker->lock) );
+    WakeWorker( worker );
+    pthread_mutex_unlock( &(worker->lock) );
+  }
+  for( size_t workerIndex = 0; workerIndex < executor->workersNumber; workerIndex++ )
+  {
+    if( executor->workersList[ workerIndex ].hasThread ) pthread_join( executor->workersList[ workerIndex ].thread, NULL );
+  }
+  // Workers may return robots to any other worker, so all of them must be stopped first
+  for( size_t workerIndex = 0; workerIndex < executor->workersNumber; workerIndex++ )
+  {
+    WorkerData* worker = &(executor->workersList[ workerIndex ]);
+    pthread_mutex_destroy( &(worker->lock) );
+    pthread_cond_destroy( &(worker->wakeupSignal) );
+    free( worker->releaseHeap );
+  }
+  
+  free( executor->workersList );
+  free( executor->robotsList );
+  
+  sem_destroy( &(executor->placementSignal) );
+  
+  free( executor );
+}
+
+size_t FleetExecutor_GetWorkersNumber( FleetExecutor executor )
+{
+  return executor->workersNumber;
+}
+
+bool FleetExecutor_GetWorkerStatus( FleetExecutor executor, size_t workerIndex, FleetWorkerStatus* status )
+{
+  if( workerIndex >= executor->workersNumber ) return false;
+  
+  WorkerData* worker = &(executor->workersList[ workerIndex ]);
+  int64_t busyTimeNs = atomic_load_explicit( &(worker->busyTimeNs), memory_order_relaxed );
+  int64_t elapsedTimeNs = GetCurrentTimeNs() - executor->startTimeNs;
+  status->cpu = atomic_load_explicit( &(worker->cpu), memory_order_relaxed );
+  status->stepsCount = atomic_load_explicit( &(worker->stepsCount), memory_order_relaxed );
+  status->stolenStepsCount = atomic_load_explicit( &(worker->stolenStepsCount), memory_order_relaxed );
+  status->busyTime = (double) busyTimeNs / NSECS_PER_SEC;
+  status->utilization = ( elapsedTimeNs > 0 ) ? (double) busyTimeNs / elapsedTimeNs : 0.0;
+  status->migrationsCount = atomic_load_explicit( &(worker->migrationsCount), memory_order_relaxed );
+  int threadID = atomic_load_explicit( &(worker->threadID), memory_order_relaxed );
+  status->involuntarySwitchesCount = ( threadID > 0 ) ? ControlPlacement_GetInvoluntarySwitchesCount( threadID ) : 0;
+  
+  return true;
+}
+
+bool FleetExecutor_GetRobotStatus( FleetExecutor executor, int robotIndex, FleetRobotStatus* status )
+{
+  if( robotIndex < 0 || (size_t) robotIndex >= executor->robotsNumber ) return false;
+  
+  Robot* robot = &(executor->robotsList[ robotIndex ]);
+  status->stepsCount = atomic_load_explicit( &(robot->stepsCount), memory_order_acquire );
+  status->lastTimeDelta = atomic_load_explicit( &(robot->lastTimeDelta), memory_order_relaxed );
+  status->maxReleaseLatency = atomic_load_explicit( &(robot->maxReleaseLatency), memory_order_relaxed );
+  status->maxStepDuration = atomic_load_explicit( &(robot->maxStepDuration), memory_order_relaxed );
+  status->deadlineMissesCount = atomic_load_explicit( &(robot->deadlineMissesCount), memory_order_relaxed );
+  
+  return true;
+}
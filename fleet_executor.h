@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file fleet_executor.h
+/// @brief Multi-threaded executor for control steps of many robots (plugin instances) with individual periods
+///
+/// Robot steps are distributed among a pool of worker threads, balanced by step rate. Each worker runs its due robot steps in
+/// earliest release order, and idle workers steal due steps waiting on busy ones, so that a slow plugin instance doesn't stall the others
+
+#ifndef FLEET_EXECUTOR_H
+#define FLEET_EXECUTOR_H
+
+#include "control_loop.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Fleet executor configuration. Zero-initialized members use default values
+typedef struct FleetExecutorSettings
+{
+  size_t workersNumber;                   ///< Number of worker threads, or 0 for one per available CPU
+  int priority;                           ///< SCHED_FIFO real-time priority (1-99) of worker threads, or 0 for default scheduling
+  bool pinWorkers;                        ///< Pin each worker thread to a different available (or placement) CPU (one worker per core)
+  double stealDelay;                      ///< Time (in seconds) a due step waits for its owner worker before others may take it, or 0 for default (50 us)
+  const ControlPlacement* placement;      ///< CPUs and memory node of worker threads (should pass ControlPlacement_Validate without errors, and executor start fails if it can't be applied), or NULL for default
+}
+FleetExecutorSettings;
+
+/// Fleet executor worker status, readable from other threads
+typedef struct FleetWorkerStatus
+{
+  int cpu;                                ///< CPU the worker thread ran its last step on, or -1 if it didn't run any
+  uint64_t stepsCount;                    ///< Number of robot steps executed by worker since executor start
+  uint64_t stolenStepsCount;              ///< Number of executed steps belonging to robots of other workers
+  double busyTime;                        ///< Total time (in seconds) spent running steps since executor start
+  double utilization;                     ///< Fraction (0.0-1.0) of time spent running steps since executor start
+  uint64_t migrationsCount;               ///< Number of times the worker thread changed CPUs between steps
+  uint64_t involuntarySwitchesCount;      ///< Number of times the worker thread was preempted by other tasks (interference)
+}
+FleetWorkerStatus;
+
+/// Fleet executor robot status, readable from other threads
+typedef struct FleetRobotStatus
+{
+  uint64_t stepsCount;                    ///< Number of steps executed since executor start
+  double lastTimeDelta;                   ///< Time delta (in seconds) passed to the last step
+  double maxReleaseLatency;               ///< Maximum delay (in seconds) between step release time and its actual start
+  double maxStepDuration;                 ///< Maximum execution time (in seconds) of robot step
+  uint64_t deadlineMissesCount;           ///< Number of steps that didn't end before the next release time
+}
+FleetRobotStatus;
+
+/// Opaque fleet executor data
+typedef struct _FleetExecutorData FleetExecutorData;
+/// Opaque reference to fleet executor
+typedef FleetExecutorData* FleetExecutor;
+
+/// @brief Creates (not yet running) fleet executor with given settings
+/// @param[in] settings reference to executor configuration
+/// @return reference to created executor on success, NULL otherwise
+FleetExecutor FleetExecutor_Create( const FleetExecutorSettings* settings );
+
+/// @brief Adds robot control step to be run periodically by fleet executor. Must be called before FleetExecutor_Start
+/// @param[in] executor reference to fleet executor
+/// @param[in] stepPeriod robot control step period (in seconds)
+/// @param[in] runStep control step function (usually wrapping a plugin RunControlStep or RunInstanceControlStep call)
+/// @param[in] stepData reference to user data passed to each step call
+/// @return index of added robot on success, -1 otherwise
+int FleetExecutor_AddRobot( FleetExecutor executor, double stepPeriod, ControlStepFunction runStep, void* stepData );
+
+/// @brief Starts worker threads of fleet executor, with all added robots released at once
+/// @param[in] executor reference to fleet executor
+/// @return true on success, false otherwise (e.g. no robots added, already started or not permitted real-time priority)
+bool FleetExecutor_Start( FleetExecutor executor );
+
+/// @brief Stops worker threads of fleet executor (after their current steps end) and deallocates its data
+/// @param[in] executor reference to fleet executor
+void FleetExecutor_Discard( FleetExecutor executor );
+
+/// @brief Gets number of worker threads of fleet executor
+/// @param[in] executor reference to fleet executor
+/// @return number of worker threads
+size_t FleetExecutor_GetWorkersNumber( FleetExecutor executor );
+
+/// @brief Gets current execution status of fleet executor worker (per core, if pinned)
+/// @param[in] executor reference to fleet executor
+/// @param[in] workerIndex index of worker
+/// @param[out] status reference to status structure to be filled
+/// @return true on success, false for invalid worker index
+bool FleetExecutor_GetWorkerStatus( FleetExecutor executor, size_t workerIndex, FleetWorkerStatus* status );
+
+/// @brief Gets current execution status of robot control step
+/// @param[in] executor reference to fleet executor
+/// @param[in] robotIndex index of robot returned by FleetExecutor_AddRobot
+/// @param[out] status reference to status structure to be filled
+/// @return true on success, false for invalid robot index
+bool FleetExecutor_GetRobotStatus( FleetExecutor executor, int robotIndex, FleetRobotStatus* status );
+
+#endif  // FLEET_EXECUTOR_H
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file plugin_bridge.h
+/// @brief Shared memory call bridge layout between plugin host client (plugin_host.h) and robot_control_host process
+///
+/// A single call slot: the client fills arguments and sets the call state, the host runs the plugin function, fills results and sets
+/// the return state. Both sides spin briefly on state changes (if running on different CPUs) before sleeping on a (process shared) futex
+
+#ifndef PLUGIN_BRIDGE_H
+#define PLUGIN_BRIDGE_H
+
+#include "robot_control.h"
+
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLUGIN_BRIDGE_MAX_DOFS 64                 ///< Maximum number of joints or axes of hosted plugins
+#define PLUGIN_BRIDGE_MAX_EXTRAS 64               ///< Maximum number of extra inputs or outputs of hosted plugins
+#define PLUGIN_BRIDGE_NAME_LENGTH 64              ///< Maximum length (with terminator) of joint and axis names
+#define PLUGIN_BRIDGE_CONFIG_LENGTH 4096          ///< Maximum length (with terminator) of controller configuration string
+#define PLUGIN_BRIDGE_SPIN_TIME_NS 20000          ///< Time spent polling for a state change before sleeping, on multiprocessor machines
+
+#define PLUGIN_BRIDGE_CALL_INDEX( rtype, Interface, name, ... ) PLUGIN_BRIDGE_##name,
+
+/// Bridged calls enumeration: one per ROBOT_CONTROL_INTERFACE function, plus host process exit
+enum PluginBridgeCall { ROBOT_CONTROL_INTERFACE( , PLUGIN_BRIDGE_CALL_INDEX ) PLUGIN_BRIDGE_EXIT };
+
+/// Call slot states enumeration
+enum PluginBridgeState 
+{ 
+  PLUGIN_BRIDGE_IDLE,         ///< No call in progress
+  PLUGIN_BRIDGE_CALL,         ///< Arguments written by client, to be processed by host
+  PLUGIN_BRIDGE_RETURN        ///< Results written by host, to be read by client
+};
+
+/// Shared memory segment layout
+typedef struct DOF_CACHE_LINE_ALIGNED PluginBridge
+{
+  atomic_uint state;                                              ///< Call slot state (futex word)
+  int64_t spinTimeNs;                                             ///< Time spent polling for state changes (0 when both sides can't run in parallel)
+  uint32_t call;                                                  ///< Requested call
+  uint32_t returnValue;                                           ///< Boolean or size returned by call
+  uint32_t hasNames;                                              ///< Whether names list returned by plugin was not NULL
+  int32_t controlState;
+  double timeDelta;
+  uint32_t jointsNumber, axesNumber;                              ///< Numbers of degrees-of-freedom, set by host after controller initialization
+  uint32_t extraInputsNumber, extraOutputsNumber;                 ///< Numbers of extra values, set by host after controller initialization
+  char configuration[ PLUGIN_BRIDGE_CONFIG_LENGTH ];
+  char namesList[ PLUGIN_BRIDGE_MAX_DOFS ][ PLUGIN_BRIDGE_NAME_LENGTH ];
+  DoFVariables jointMeasuresList[ PLUGIN_BRIDGE_MAX_DOFS ];
+  DoFVariables axisMeasuresList[ PLUGIN_BRIDGE_MAX_DOFS ];
+  DoFVariables jointSetpointsList[ PLUGIN_BRIDGE_MAX_DOFS ];
+  DoFVariables axisSetpointsList[ PLUGIN_BRIDGE_MAX_DOFS ];
+  double extrasList[ PLUGIN_BRIDGE_MAX_EXTRAS ];
+}
+PluginBridge;
+
+/// @brief Sets call slot state and wakes the other side
+/// @param[in] bridge reference to shared bridge segment
+/// @param[in] state new call slot state
+static inline void PluginBridge_SetState( PluginBridge* bridge, enum PluginBridgeState state )
+{
+  atomic_store_explicit( &(bridge->state), state, memory_order_release );
+  syscall( SYS_futex, &(bridge->state), FUTEX_WAKE, 1, NULL, NULL, 0 );
+}
+
+/// @brief Waits for call slot to reach given state, spinning for a short time before sleeping
+/// @param[in] bridge reference to shared bridge segment
+/// @param[in] state expected call slot state
+/// @param[in] timeoutNs maximum time (in nanoseconds) to be waited, or a negative value for no timeout
+/// @return true if expected state was reached, false on timeout
+static inline bool PluginBridge_WaitState( PluginBridge* bridge, enum PluginBridgeState state, int64_t timeoutNs )
+{
+  struct timespec startTime, currentTime;
+  clock_gettime( CLOCK_MONOTONIC, &startTime );
+  int64_t elapsedTimeNs = 0;
+  
+  while( true )
+  {
+    unsigned currentState = atomic_load_explicit( &(bridge->state), memory_order_acquire );
+    if( currentState == (unsigned) state ) return true;
+    
+    clock_gettime( CLOCK_MONOTONIC, &currentTime );
+    elapsedTimeNs = ( currentTime.tv_sec - startTime.tv_sec ) * 1000000000LL + ( currentTime.tv_nsec - startTime.tv_nsec );
+    if( timeoutNs >= 0 && elapsedTimeNs >= timeoutNs ) return false;
+    if( elapsedTimeNs < bridge->spinTimeNs ) continue;
+    
+    int64_t sleepTimeNs = ( timeoutNs >= 0 ) ? timeoutNs - elapsedTimeNs : -1;
+    struct timespec sleepTime = { .tv_sec = sleepTimeNs / 1000000000LL, .tv_nsec = sleepTimeNs % 1000000000LL };
+    syscall( SYS_futex, &(bridge->state), FUTEX_WAIT, currentState, ( sleepTimeNs >= 0 ) ? &sleepTime : NULL, NULL, 0 );
+  }
+}
+
+#endif  // PLUGIN_BRIDGE_H
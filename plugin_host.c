@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "plugin_host.h"
+#include "plugin_bridge.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define DEFAULT_HOST_PATH "robot_control_host"
+#define LIVENESS_CHECK_INTERVAL_NS 1000000LL
+
+extern char** environ;
+
+struct _PluginHostData
+{
+  size_t slotIndex;
+  pid_t pid;
+  PluginBridge* bridge;
+  int64_t stepTimeoutNs, callTimeoutNs;
+  bool isAlive;
+  size_t jointsNumber, axesNumber;                    // Read from bridge only once after controller initialization,
+  size_t extraInputsNumber, extraOutputsNumber;       // as the hosted process may change them at any time
+  char jointNamesBuffer[ PLUGIN_BRIDGE_MAX_DOFS ][ PLUGIN_BRIDGE_NAME_LENGTH ];
+  char axisNamesBuffer[ PLUGIN_BRIDGE_MAX_DOFS ][ PLUGIN_BRIDGE_NAME_LENGTH ];
+  const char* jointNamesList[ PLUGIN_BRIDGE_MAX_DOFS ];
+  const char* axisNamesList[ PLUGIN_BRIDGE_MAX_DOFS ];
+};
+
+static PluginHost hostsList[ PLUGIN_HOST_MAX_INSTANCES ];
+static pthread_mutex_t hostsLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void KillHost( PluginHost host )
+{
+  if( !host->isAlive ) return;
+  
+  kill( host->pid, SIGKILL );
+  waitpid( host->pid, NULL, 0 );
+  host->isAlive = false;
+}
+
+// Host process may also be reaped by the application (e.g. ignoring SIGCHLD), in which case its existence is checked directly
+static bool IsHostRunning( PluginHost host )
+{
+  pid_t result = waitpid( host->pid, NULL, WNOHANG );
+  if( result == host->pid ) return false;
+  if( result == -1 && errno == ECHILD ) return ( kill( host->pid, 0 ) == 0 || errno != ESRCH );
+  
+  return true;
+}
+
+// Waits for call return, checking (in intervals) if host process is still running, until timeout (if positive)
+static bool CallHost( PluginHost host, enum PluginBridgeCall call, int64_t timeoutNs )
+{
+  if( !host->isAlive ) return false;
+  
+  host->bridge->call = call;
+  PluginBridge_SetState( host->bridge, PLUGIN_BRIDGE_CALL );
+  
+  int64_t waitTimeNs = 0;
+  while( !PluginBridge_WaitState( host->bridge, PLUGIN_BRIDGE_RETURN, LIVENESS_CHECK_INTERVAL_NS ) )
+  {
+    waitTimeNs += LIVENESS_CHECK_INTERVAL_NS;
+    if( !IsHostRunning( host ) ) host->isAlive = false;
+    else if( timeoutNs > 0 && waitTimeNs >= timeoutNs ) KillHost( host );
+    if( !host->isAlive ) return false;
+  }
+  
+  atomic_store_explicit( &(host->bridge->state), PLUGIN_BRIDGE_IDLE, memory_order_relaxed );
+  
+  return true;
+}
+
+static inline size_t ClampNumber( uint32_t number, size_t maxNumber )
+{
+  return ( number < maxNumber ) ? number : maxNumber;
+}
+
+static bool HostInitController( PluginHost host, const char* configuration )
+{
+  strncpy( host->bridge->configuration, ( configuration != NULL ) ? configuration : "", PLUGIN_BRIDGE_CONFIG_LENGTH - 1 );
+  if( !CallHost( host, PLUGIN_BRIDGE_InitController, host->callTimeoutNs ) ) return false;
+  if( !host->bridge->returnValue ) return false;
+  
+  host->jointsNumber = ClampNumber( host->bridge->jointsNumber, PLUGIN_BRIDGE_MAX_DOFS );
+  host->axesNumber = ClampNumber( host->bridge->axesNumber, PLUGIN_BRIDGE_MAX_DOFS );
+  host->extraInputsNumber = ClampNumber( host->bridge->extraInputsNumber, PLUGIN_BRIDGE_MAX_EXTRAS );
+  host->extraOutputsNumber = ClampNumber( host->bridge->extraOutputsNumber, PLUGIN_BRIDGE_MAX_EXTRAS );
+  
+  return true;
+}
+
+static void HostEndController( PluginHost host )
+{
+  CallHost( host, PLUGIN_BRIDGE_EndController, host->callTimeoutNs );
+}
+
+// Numbers are the ones used for copying variables, and don't change after controller initialization
+static size_t HostGetNumber( PluginHost host, size_t number )
+{
+  return host->isAlive ? number : 0;
+}
+
+static const char** HostGetNamesList( PluginHost host, enum PluginBridgeCall call, size_t namesNumber, 
+                                      char namesBuffer[][ PLUGIN_BRIDGE_NAME_LENGTH ], const char** namesList )
+{
+  if( !CallHost( host, call, host->callTimeoutNs ) ) return NULL;
+  if( !host->bridge->hasNames ) return NULL;
+  
+  for( size_t nameIndex = 0; nameIndex < namesNumber; nameIndex++ )
+  {
+    memcpy( namesBuffer[ nameIndex ], host->bridge->namesList[ nameIndex ], PLUGIN_BRIDGE_NAME_LENGTH );
+    namesBuffer[ nameIndex ][ PLUGIN_BRIDGE_NAME_LENGTH - 1 ] = '\0';
+    namesList[ nameIndex ] = namesBuffer[ nameIndex ];
+  }
+  
+  return namesList;
+}
+
+static void HostSetControlState( PluginHost host, enum ControlState controlState )
+{
+  host->bridge->controlState = (int32_t) controlState;
+  CallHost( host, PLUGIN_BRIDGE_SetControlState, host->callTimeoutNs );
+}
+
+static void CopyToBridge( DoFVariables* bridgeList, DoFVariables** list, size_t dofsNumber )
+{
+  if( list == NULL ) return;
+  
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+    bridgeList[ dofIndex ] = *(list[ dofIndex ]);
+}
+
+static void CopyFromBridge( DoFVariables** list, const DoFVariables* bridgeList, size_t dofsNumber )
+{
+  if( list == NULL ) return;
+  
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+    *(list[ dofIndex ]) = bridgeList[ dofIndex ];
+}
+
+static void HostRunControlStep( PluginHost host, DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, 
+                                DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+{
+  PluginBridge* bridge = host->bridge;
+  
+  // All lists are copied both ways, as plugins may update any of them
+  CopyToBridge( bridge->jointMeasuresList, jointMeasuresList, host->jointsNumber );
+  CopyToBridge( bridge->axisMeasuresList, axisMeasuresList, host->axesNumber );
+  CopyToBridge( bridge->jointSetpointsList, jointSetpointsList, host->jointsNumber );
+  CopyToBridge( bridge->axisSetpointsList, axisSetpointsList, host->axesNumber );
+  bridge->timeDelta = timeDelta;
+  
+  if( !CallHost( host, PLUGIN_BRIDGE_RunControlStep, host->stepTimeoutNs ) ) return;
+  
+  CopyFromBridge( jointMeasuresList, bridge->jointMeasuresList, host->jointsNumber );
+  CopyFromBridge( axisMeasuresList, bridge->axisMeasuresList, host->axesNumber );
+  CopyFromBridge( jointSetpointsList, bridge->jointSetpointsList, host->jointsNumber );
+  CopyFromBridge( axisSetpointsList, bridge->axisSetpointsList, host->axesNumber );
+}
+
+static void HostSetExtraInputsList( PluginHost host, double* inputsList )
+{
+  memcpy( host->bridge->extrasList, inputsList, host->extraInputsNumber * sizeof(double) );
+  CallHost( host, PLUGIN_BRIDGE_SetExtraInputsList, host->callTimeoutNs );
+}
+
+static void HostGetExtraOutputsList( PluginHost host, double* outputsList )
+{
+  if( !CallHost( host, PLUGIN_BRIDGE_GetExtraOutputsList, host->callTimeoutNs ) ) return;
+  
+  memcpy( outputsList, host->bridge->extrasList, host->extraOutputsNumber * sizeof(double) );
+}
+
+// Interface functions have no context argument, so each host slot gets its own set of forwarding functions
+#define DEFINE_SLOT_FUNCTIONS( slot ) \
+        static bool InitController_##slot( const char* configuration ) { return HostInitController( hostsList[ slot ], configuration ); } \
+        static void EndController_##slot( void ) { HostEndController( hostsList[ slot ] ); } \
+        static size_t GetJointsNumber_##slot( void ) { return HostGetNumber( hostsList[ slot ], hostsList[ slot ]->jointsNumber ); } \
+        static const char** GetJointNamesList_##slot( void ) { PluginHost host = hostsList[ slot ]; \
+          return HostGetNamesList( host, PLUGIN_BRIDGE_GetJointNamesList, host->jointsNumber, host->jointNamesBuffer, host->jointNamesList ); } \
+        static size_t GetAxesNumber_##slot( void ) { return HostGetNumber( hostsList[ slot ], hostsList[ slot ]->axesNumber ); } \
+        static const char** GetAxisNamesList_##slot( void ) { PluginHost host = hostsList[ slot ]; \
+          return HostGetNamesList( host, PLUGIN_BRIDGE_GetAxisNamesList, host->axesNumber, host->axisNamesBuffer, host->axisNamesList ); } \
+        static void SetControlState_##slot( enum ControlState controlState ) { HostSetControlState( hostsList[ slot ], controlState ); } \
+        static void RunControlStep_##slot( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, \
+                                           DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta ) \
+          { HostRunControlStep( hostsList[ slot ], jointMeasuresList, axisMeasuresList, jointSetpointsList, axisSetpointsList, timeDelta ); } \
+        static size_t GetExtraInputsNumber_##slot( void ) { return HostGetNumber( hostsList[ slot ], hostsList[ slot ]->extraInputsNumber ); } \
+        static void SetExtraInputsList_##slot( double* inputsList ) { HostSetExtraInputsList( hostsList[ slot ], inputsList ); } \
+        static size_t GetExtraOutputsNumber_##slot( void ) { return HostGetNumber( hostsList[ slot ], hostsList[ slot ]->extraOutputsNumber ); } \
+        static void GetExtraOutputsList_##slot( double* outputsList ) { HostGetExtraOutputsList( hostsList[ slot ], outputsList ); }
+
+#define SLOT_FUNCTION_REFERENCE( rtype, Interface, name, ... ) .name = name##_##Interface,
+#define SLOT_FUNCTIONS( slot ) { ROBOT_CONTROL_INTERFACE( slot, SLOT_FUNCTION_REFERENCE ) }
+
+DEFINE_SLOT_FUNCTIONS( 0 )
+DEFINE_SLOT_FUNCTIONS( 1 )
+DEFINE_SLOT_FUNCTIONS( 2 )
+DEFINE_SLOT_FUNCTIONS( 3 )
+DEFINE_SLOT_FUNCTIONS( 4 )
+DEFINE_SLOT_FUNCTIONS( 5 )
+DEFINE_SLOT_FUNCTIONS( 6 )
+DEFINE_SLOT_FUNCTIONS( 7 )
+DEFINE_SLOT_FUNCTIONS( 8 )
+DEFINE_SLOT_FUNCTIONS( 9 )
+DEFINE_SLOT_FUNCTIONS( 10 )
+DEFINE_SLOT_FUNCTIONS( 11 )
+DEFINE_SLOT_FUNCTIONS( 12 )
+DEFINE_SLOT_FUNCTIONS( 13 )
+DEFINE_SLOT_FUNCTIONS( 14 )
+DEFINE_SLOT_FUNCTIONS( 15 )
+
+static const RobotControlFunctions SLOT_FUNCTIONS_LIST[ PLUGIN_HOST_MAX_INSTANCES ] = 
+{ 
+  SLOT_FUNCTIONS( 0 ), SLOT_FUNCTIONS( 1 ), SLOT_FUNCTIONS( 2 ), SLOT_FUNCTIONS( 3 ), SLOT_FUNCTIONS( 4 ), SLOT_FUNCTIONS( 5 ), SLOT_FUNCTIONS( 6 ), SLOT_FUNCTIONS( 7 ), 
+  SLOT_FUNCTIONS( 8 ), SLOT_FUNCTIONS( 9 ), SLOT_FUNCTIONS( 10 ), SLOT_FUNCTIONS( 11 ), SLOT_FUNCTIONS( 12 ), SLOT_FUNCTIONS( 13 ), SLOT_FUNCTIONS( 14 ), SLOT_FUNCTIONS( 15 ) 
+};
+
+PluginHost PluginHost_Start( const char* hostPath, const char* pluginPath, double stepTimeout, double callTimeout )
+{
+  if( pluginPath == NULL || stepTimeout < 0.0 || callTimeout < 0.0 ) return NULL;
+  
+  PluginHost newHost = (PluginHost) calloc( 1, sizeof(PluginHostData) );
+  if( newHost == NULL ) return NULL;
+  newHost->stepTimeoutNs = (int64_t) ( stepTimeout * 1e9 );
+  newHost->callTimeoutNs = (int64_t) ( callTimeout * 1e9 );
+  
+  // Bridge file descriptor is only inherited by (and its number passed to) its own host process, 
+  // and not by hosts started meanwhile by other threads
+  int bridgeFD = memfd_create( "robot_control_bridge", MFD_CLOEXEC );
+  if( bridgeFD == -1 || ftruncate( bridgeFD, sizeof(PluginBridge) ) != 0 
+      || ( newHost->bridge = (PluginBridge*) mmap( NULL, sizeof(PluginBridge), PROT_READ | PROT_WRITE, MAP_SHARED, bridgeFD, 0 ) ) == MAP_FAILED )
+  {
+    if( bridgeFD != -1 ) close( bridgeFD );
+    free( newHost );
+    return NULL;
+  }
+  atomic_init( &(newHost->bridge->state), PLUGIN_BRIDGE_IDLE );
+  newHost->bridge->spinTimeNs = ( sysconf( _SC_NPROCESSORS_ONLN ) > 1 ) ? PLUGIN_BRIDGE_SPIN_TIME_NS : 0;
+  
+  pthread_mutex_lock( &hostsLock );
+  newHost->slotIndex = PLUGIN_HOST_MAX_INSTANCES;
+  for( size_t slotIndex = 0; slotIndex < PLUGIN_HOST_MAX_INSTANCES && newHost->slotIndex == PLUGIN_HOST_MAX_INSTANCES; slotIndex++ )
+  {
+    if( hostsList[ slotIndex ] == NULL ) newHost->slotIndex = slotIndex;
+  }
+  if( newHost->slotIndex < PLUGIN_HOST_MAX_INSTANCES )
+  {
+    char bridgeFDString[ 16 ];
+    snprintf( bridgeFDString, sizeof(bridgeFDString), "%d", bridgeFD );
+    char* argumentsList[] = { (char*) ( ( hostPath != NULL ) ? hostPath : DEFAULT_HOST_PATH ), bridgeFDString, (char*) pluginPath, NULL };
+    // Duplication to the same descriptor clears its close-on-exec flag in the child process only
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init( &fileActions );
+    if( posix_spawn_file_actions_adddup2( &fileActions, bridgeFD, bridgeFD ) == 0 )
+      newHost->isAlive = ( posix_spawnp( &(newHost->pid), argumentsList[ 0 ], &fileActions, NULL, argumentsList, environ ) == 0 );
+    posix_spawn_file_actions_destroy( &fileActions );
+    if( newHost->isAlive ) hostsList[ newHost->slotIndex ] = newHost;
+  }
+  pthread_mutex_unlock( &hostsLock );
+  close( bridgeFD );
+  
+  if( !newHost->isAlive )
+  {
+    munmap( newHost->bridge, sizeof(PluginBridge) );
+    free( newHost );
+    return NULL;
+  }
+  
+  return newHost;
+}
+
+void PluginHost_Stop( PluginHost host )
+{
+  if( host == NULL ) return;
+  
+  if( CallHost( host, PLUGIN_BRIDGE_EXIT, host->callTimeoutNs ) )
+  {
+    waitpid( host->pid, NULL, 0 );
+    host->isAlive = false;
+  }
+  KillHost( host );
+  
+  pthread_mutex_lock( &hostsLock );
+  hostsList[ host->slotIndex ] = NULL;
+  pthread_mutex_unlock( &hostsLock );
+  
+  munmap( host->bridge, sizeof(PluginBridge) );
+  free( host );
+}
+
+const RobotControlFunctions* PluginHost_GetFunctions( PluginHost host )
+{
+  return &(SLOT_FUNCTIONS_LIST[ host->slotIndex ]);
+}
+
+bool PluginHost_IsAlive( PluginHost host )
+{
+  return host->isAlive;
+}
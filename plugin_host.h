@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file plugin_host.h
+/// @brief Out-of-process robot control plugin hosting
+///
+/// Runs a plugin inside its own robot_control_host process, so that its crashes or hangs don't take down the host application (and the other
+/// robots it controls). The returned RobotControlFunctions table forwards every ROBOT_CONTROL_INTERFACE call through a shared memory bridge,
+/// signalled with futexes (spinning briefly first, for round trips of a few microseconds on idle or isolated cores). Calls to the same hosted 
+/// plugin must not be concurrent. After the host process dies, calls return default values (false, 0 or NULL) and control steps do nothing
+
+#ifndef PLUGIN_HOST_H
+#define PLUGIN_HOST_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+
+#define PLUGIN_HOST_MAX_INSTANCES 16      ///< Maximum number of simultaneously hosted plugins per process
+
+/// Opaque plugin host data
+typedef struct _PluginHostData PluginHostData;
+/// Opaque reference to plugin host process
+typedef PluginHostData* PluginHost;
+
+/// @brief Starts plugin host process, loading given plugin library
+/// @param[in] hostPath path to robot_control_host executable, or NULL to search for it in PATH
+/// @param[in] pluginPath path to plugin library to be loaded by host process
+/// @param[in] stepTimeout maximum duration (in seconds) of control steps, after which the host process is considered hung and killed, or 0 for no limit
+/// @param[in] callTimeout maximum duration (in seconds) of any other call (including controller initialization), with the same behavior, or 0 for no limit
+/// @return reference to running host on success, NULL otherwise
+PluginHost PluginHost_Start( const char* hostPath, const char* pluginPath, double stepTimeout, double callTimeout );
+
+/// @brief Stops plugin host process (EndController should be called before, if controller was initialized) and deallocates its data
+/// @param[in] host reference to plugin host
+void PluginHost_Stop( PluginHost host );
+
+/// @brief Gets table of plugin interface functions forwarding calls to host process
+/// @param[in] host reference to plugin host
+/// @return reference to functions table, valid until host is stopped
+const RobotControlFunctions* PluginHost_GetFunctions( PluginHost host );
+
+/// @brief Checks if plugin host process is still running (neither crashed nor killed for a call timeout)
+/// @param[in] host reference to plugin host
+/// @return true if host is running, false otherwise
+bool PluginHost_IsAlive( PluginHost host );
+
+#endif  // PLUGIN_HOST_H
@@ -34,7 +34,14 @@
 #define M_PI 3.14159      ///< Defines mathematical Pi value if standard math.h one is not available
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Plug-in Loader macros, for plugins and applications loading them. Not needed by helper libraries (e.g. built without the submodule)
+#ifndef ROBOT_CONTROL_NO_PLUGIN_LOADER
 #include "plugin_loader/loader_macros.h"
+#endif
 
 /// Defined possible control states enumeration. Passed to generic or plugin specific robot control implementations
 enum ControlState 
@@ -54,6 +61,166 @@ typedef struct DoFVariables
 }
 DoFVariables;
 
+#define DOF_VARIABLES_NUMBER 7    ///< Number of control variables (fields) for each degree-of-freedom
+
+/// Control variables of multiple degrees-of-freedom, stored as contiguous per-field arrays (structure of arrays)
+typedef struct DoFVariablesArrays
+{
+  double* position, * velocity, * force, * acceleration, * inertia, * stiffness, * damping;
+}
+DoFVariablesArrays;
+
+/// @brief Points per-field arrays to consecutive segments of a single buffer (all positions, then all velocities, and so on)
+/// @param[out] arrays reference to structure of arrays to be set
+/// @param[in] buffer reference/pointer to block of at least DOF_VARIABLES_NUMBER * dofsNumber values
+/// @param[in] dofsNumber number of degrees-of-freedom (length of each per-field array)
+static inline void DoFVariablesArrays_Bind( DoFVariablesArrays* arrays, double* buffer, size_t dofsNumber )
+{
+  arrays->position = buffer;
+  arrays->velocity = arrays->position + dofsNumber;
+  arrays->force = arrays->velocity + dofsNumber;
+  arrays->acceleration = arrays->force + dofsNumber;
+  arrays->inertia = arrays->acceleration + dofsNumber;
+  arrays->stiffness = arrays->inertia + dofsNumber;
+  arrays->damping = arrays->stiffness + dofsNumber;
+}
+
+/// Single precision counterpart of DoFVariables, for plugins/targets where float precision is enough and SIMD lanes or memory bandwidth are scarce
+typedef struct FloatDoFVariables
+{
+  float position, velocity, force, acceleration, inertia, stiffness, damping;
+}
+FloatDoFVariables;
+
+/// @brief Converts list of double precision variables to single precision ones
+/// @param[out] floatList list of per degree-of-freedom single precision variables to be updated
+/// @param[in] list list of per degree-of-freedom source variables
+/// @param[in] dofsNumber number of elements in both lists
+static inline void FloatDoFVariables_StoreList( FloatDoFVariables** floatList, DoFVariables** list, size_t dofsNumber )
+{
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+  {
+    floatList[ dofIndex ]->position = (float) list[ dofIndex ]->position;
+    floatList[ dofIndex ]->velocity = (float) list[ dofIndex ]->velocity;
+    floatList[ dofIndex ]->force = (float) list[ dofIndex ]->force;
+    floatList[ dofIndex ]->acceleration = (float) list[ dofIndex ]->acceleration;
+    floatList[ dofIndex ]->inertia = (float) list[ dofIndex ]->inertia;
+    floatList[ dofIndex ]->stiffness = (float) list[ dofIndex ]->stiffness;
+    floatList[ dofIndex ]->damping = (float) list[ dofIndex ]->damping;
+  }
+}
+
+/// @brief Converts list of single precision variables to double precision ones
+/// @param[in] floatList list of per degree-of-freedom single precision source variables
+/// @param[out] list list of per degree-of-freedom variables to be updated
+/// @param[in] dofsNumber number of elements in both lists
+static inline void FloatDoFVariables_LoadList( FloatDoFVariables** floatList, DoFVariables** list, size_t dofsNumber )
+{
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+  {
+    list[ dofIndex ]->position = floatList[ dofIndex ]->position;
+    list[ dofIndex ]->velocity = floatList[ dofIndex ]->velocity;
+    list[ dofIndex ]->force = floatList[ dofIndex ]->force;
+    list[ dofIndex ]->acceleration = floatList[ dofIndex ]->acceleration;
+    list[ dofIndex ]->inertia = floatList[ dofIndex ]->inertia;
+    list[ dofIndex ]->stiffness = floatList[ dofIndex ]->stiffness;
+    list[ dofIndex ]->damping = floatList[ dofIndex ]->damping;
+  }
+}
+
+/// Control variables bit flags enumeration, combined in DoFChangesMask values
+enum DoFVariableFlag
+{
+  DOF_POSITION = 0x01,                                        ///< Flag for position variable
+  DOF_VELOCITY = 0x02,                                        ///< Flag for velocity variable
+  DOF_FORCE = 0x04,                                           ///< Flag for force variable
+  DOF_ACCELERATION = 0x08,                                    ///< Flag for acceleration variable
+  DOF_INERTIA = 0x10,                                         ///< Flag for inertia variable
+  DOF_STIFFNESS = 0x20,                                       ///< Flag for stiffness variable
+  DOF_DAMPING = 0x40,                                         ///< Flag for damping variable
+  DOF_IMPEDANCE = DOF_INERTIA | DOF_STIFFNESS | DOF_DAMPING,  ///< Flags for all impedance variables
+  DOF_ALL_VARIABLES = 0x7F                                    ///< Flags for all control variables
+};
+
+/// Set of DoFVariableFlag values indicating which control variables of a degree-of-freedom changed since the last control step
+typedef uint8_t DoFChangesMask;
+
+#define DOF_CACHE_LINE_SIZE 64    ///< Size and alignment (in bytes) of AlignedDoFVariables, matching common CPU cache lines
+
+// Release store and acquire load of update sequences (MSVC volatile accesses have these semantics with its default /volatile:ms)
+#if defined( _MSC_VER )
+  #define DOF_CACHE_LINE_ALIGNED __declspec( align( DOF_CACHE_LINE_SIZE ) )
+  #define DOF_SEQUENCE_STORE( sequence, value ) ( *( (volatile uint64_t*) &(sequence) ) = (value) )
+  #define DOF_SEQUENCE_LOAD( sequence ) ( *( (const volatile uint64_t*) &(sequence) ) )
+#else
+  #define DOF_CACHE_LINE_ALIGNED __attribute__(( aligned( DOF_CACHE_LINE_SIZE ) ))
+  #define DOF_SEQUENCE_STORE( sequence, value ) __atomic_store_n( &(sequence), (value), __ATOMIC_RELEASE )
+  #define DOF_SEQUENCE_LOAD( sequence ) __atomic_load_n( &(sequence), __ATOMIC_ACQUIRE )
+#endif
+
+/// Control variables of a single degree-of-freedom, padded and aligned to a whole cache line, so that lists of them don't share lines between threads writing adjacent elements
+/// Static and automatic lists are aligned by the compiler. Dynamically allocated ones require an aligned allocator (e.g. posix_memalign or _aligned_malloc)
+typedef struct DOF_CACHE_LINE_ALIGNED AlignedDoFVariables
+{
+  double position, velocity, force, acceleration, inertia, stiffness, damping;
+  uint64_t sequence;        ///< Update stamp (e.g. control cycle count or timestamp), release stored after the other variables
+}
+AlignedDoFVariables;
+
+/// Compile time check of AlignedDoFVariables size (fails to compile with negative array size if the layout is not a single cache line)
+typedef char AlignedDoFVariablesSizeCheck[ ( sizeof(AlignedDoFVariables) == DOF_CACHE_LINE_SIZE ) ? 1 : -1 ];
+
+/// @brief Copies variables to an aligned degree-of-freedom, stamping it with given update sequence
+/// @param[out] aligned reference to aligned degree-of-freedom variables to be updated
+/// @param[in] variables reference to source degree-of-freedom variables
+/// @param[in] sequence update stamp (e.g. current control cycle count), published with release ordering after all variables
+static inline void AlignedDoFVariables_Store( AlignedDoFVariables* aligned, const DoFVariables* variables, uint64_t sequence )
+{
+  aligned->position = variables->position;
+  aligned->velocity = variables->velocity;
+  aligned->force = variables->force;
+  aligned->acceleration = variables->acceleration;
+  aligned->inertia = variables->inertia;
+  aligned->stiffness = variables->stiffness;
+  aligned->damping = variables->damping;
+  DOF_SEQUENCE_STORE( aligned->sequence, sequence );
+}
+
+/// @brief Copies variables from an aligned degree-of-freedom
+/// The update stamp is acquire loaded before the variables, so these are at least as recent as the returned stamp. 
+/// If the writer stores again while copying, variables may mix both updates (readers needing consistent sets should compare stamps with a seqlock)
+/// @param[in] aligned reference to source aligned degree-of-freedom variables
+/// @param[out] variables reference to degree-of-freedom variables to be updated
+/// @return update stamp of copied variables, to be compared with the reader's current one
+static inline uint64_t AlignedDoFVariables_Load( const AlignedDoFVariables* aligned, DoFVariables* variables )
+{
+  uint64_t sequence = DOF_SEQUENCE_LOAD( aligned->sequence );
+  variables->position = aligned->position;
+  variables->velocity = aligned->velocity;
+  variables->force = aligned->force;
+  variables->acceleration = aligned->acceleration;
+  variables->inertia = aligned->inertia;
+  variables->stiffness = aligned->stiffness;
+  variables->damping = aligned->damping;
+  return sequence;
+}
+
+/// Opaque robot controller instance data, defined by plugins implementing ROBOT_CONTROL_INSTANCE_INTERFACE
+typedef struct _RobotControllerData RobotControllerData;
+/// Opaque reference to robot controller instance, returned by InitControllerInstance
+typedef RobotControllerData* RobotController;
+
+/// Control step arguments of a single robot controller instance, for batched steps of many robots
+typedef struct RobotControlStepData
+{
+  RobotController controller;                               ///< Reference to stepped controller instance
+  DoFVariables** jointMeasuresList;                         ///< List of per degree-of-freedom current joints measures
+  DoFVariables** axisMeasuresList;                          ///< List of per degree-of-freedom current effector measures
+  DoFVariables** jointSetpointsList;                        ///< List of per degree-of-freedom joints desired states
+  DoFVariables** axisSetpointsList;                         ///< List of per degree-of-freedom effector desired states
+}
+RobotControlStepData;
+
 /// Robot control interface declaration macro, using [Plug-in Loader](https://github.com/EESC-MKGroup/Plugin-Loader) convention
 #define ROBOT_CONTROL_INTERFACE( Interface, INIT_FUNCTION ) \
         INIT_FUNCTION( bool, Interface, InitController, const char* ) \
@@ -68,6 +235,117 @@ DoFVariables;
         INIT_FUNCTION( void, Interface, SetExtraInputsList, double* ) \
         INIT_FUNCTION( size_t, Interface, GetExtraOutputsNumber, void ) \
         INIT_FUNCTION( void, Interface, GetExtraOutputsList, double* )
+
+/// Interface function reference declaration, used for RobotControlFunctions definition
+#define ROBOT_CONTROL_FUNCTION_REFERENCE( rtype, Interface, name, ... ) rtype (*name)( __VA_ARGS__ );
+
+/// Table of references to a plugin ROBOT_CONTROL_INTERFACE functions, for hosts passing linked/loaded implementations around
+typedef struct RobotControlFunctions
+{
+  ROBOT_CONTROL_INTERFACE( , ROBOT_CONTROL_FUNCTION_REFERENCE )
+}
+RobotControlFunctions;
+
+/// Optional structure-of-arrays control step interface declaration macro, for plugins implementing it along with ROBOT_CONTROL_INTERFACE
+#define ROBOT_CONTROL_ARRAYS_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, RunControlStepArrays, DoFVariablesArrays*, DoFVariablesArrays*, DoFVariablesArrays*, DoFVariablesArrays*, double )
+
+/// Optional contiguous lists control step interface declaration macro, for plugins implementing it along with ROBOT_CONTROL_INTERFACE
+#define ROBOT_CONTROL_CONTIGUOUS_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, RunControlStepContiguous, DoFVariables*, DoFVariables*, size_t, DoFVariables*, DoFVariables*, size_t, double )
+
+/// Optional changes tracking control step interface declaration macro, for plugins implementing it along with ROBOT_CONTROL_INTERFACE
+#define ROBOT_CONTROL_MASKED_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, RunControlStepMasked, DoFVariables**, DoFVariables**, DoFVariables**, DoFVariables**, \
+                                                              DoFChangesMask*, DoFChangesMask*, DoFChangesMask*, DoFChangesMask*, double )
+
+/// Optional single precision control step interface declaration macro, for plugins implementing it along with ROBOT_CONTROL_INTERFACE
+#define ROBOT_CONTROL_FLOAT_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, RunControlStepFloat, FloatDoFVariables**, FloatDoFVariables**, FloatDoFVariables**, FloatDoFVariables**, double )
+
+/// Optional multiple instances robot control interface declaration macro, for plugins able to drive many robots from the same loaded library
+#define ROBOT_CONTROL_INSTANCE_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( RobotController, Interface, InitControllerInstance, const char* ) \
+        INIT_FUNCTION( void, Interface, EndControllerInstance, RobotController ) \
+        INIT_FUNCTION( size_t, Interface, GetInstanceJointsNumber, RobotController ) \
+        INIT_FUNCTION( const char**, Interface, GetInstanceJointNamesList, RobotController ) \
+        INIT_FUNCTION( size_t, Interface, GetInstanceAxesNumber, RobotController ) \
+        INIT_FUNCTION( const char**, Interface, GetInstanceAxisNamesList, RobotController ) \
+        INIT_FUNCTION( void, Interface, SetInstanceControlState, RobotController, enum ControlState ) \
+        INIT_FUNCTION( void, Interface, RunInstanceControlStep, RobotController, DoFVariables**, DoFVariables**, DoFVariables**, DoFVariables**, double ) \
+        INIT_FUNCTION( size_t, Interface, GetInstanceExtraInputsNumber, RobotController ) \
+        INIT_FUNCTION( void, Interface, SetInstanceExtraInputsList, RobotController, double* ) \
+        INIT_FUNCTION( size_t, Interface, GetInstanceExtraOutputsNumber, RobotController ) \
+        INIT_FUNCTION( void, Interface, GetInstanceExtraOutputsList, RobotController, double* )
+
+/// Optional batched multiple instances control step interface declaration macro, for plugins implementing it along with ROBOT_CONTROL_INSTANCE_INTERFACE
+#define ROBOT_CONTROL_BATCH_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, RunControlStepsBatch, RobotControlStepData*, size_t, double )
+
+/// Optional multiple rates control interface declaration macro, for plugins able to run joint level control and joint/axis conversions separately
+#define ROBOT_CONTROL_MULTIRATE_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, RunJointControlStep, DoFVariables**, DoFVariables**, double ) \
+        INIT_FUNCTION( void, Interface, RunAxisControlStep, DoFVariables**, DoFVariables**, DoFVariables**, DoFVariables**, double )
+
+/// Optional split phases control interface declaration macro, for plugins able to separate device I/O from control computation
+#define ROBOT_CONTROL_PHASES_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( void, Interface, ReadMeasures, DoFVariables** ) \
+        INIT_FUNCTION( void, Interface, ComputeControl, DoFVariables**, DoFVariables**, DoFVariables**, DoFVariables**, double ) \
+        INIT_FUNCTION( void, Interface, WriteSetpoints, DoFVariables** )
+
+/// Reference type for RunControlStep implementations, used to adapt contiguous lists to plugins not implementing ROBOT_CONTROL_CONTIGUOUS_INTERFACE
+typedef void (*RunControlStepFunction)( DoFVariables**, DoFVariables**, DoFVariables**, DoFVariables**, double );
+
+/// @brief Calls a plugin RunControlStep implementation with contiguous lists, building its per degree-of-freedom references on a caller provided list
+/// @param[in] runControlStep reference to loaded plugin RunControlStep implementation
+/// @param[in] referencesList reference/pointer to scratch list of at least 2 * ( jointsNumber + axesNumber ) elements, rewritten on each call
+/// @param[in,out] jointMeasuresList contiguous list of control variables representing current robot joints measures
+/// @param[in,out] jointSetpointsList contiguous list of control variables representing robot joints desired states
+/// @param[in] jointsNumber number of elements in joint lists
+/// @param[in,out] axisMeasuresList contiguous list of control variables representing current robot effector measures
+/// @param[in,out] axisSetpointsList contiguous list of control variables representing robot effector desired states
+/// @param[in] axesNumber number of elements in axis lists
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+static inline void RunControlStepContiguousShim( RunControlStepFunction runControlStep, DoFVariables** referencesList,
+                                                 DoFVariables* jointMeasuresList, DoFVariables* jointSetpointsList, size_t jointsNumber, 
+                                                 DoFVariables* axisMeasuresList, DoFVariables* axisSetpointsList, size_t axesNumber, double timeDelta )
+{
+  DoFVariables** jointMeasuresReferences = referencesList;
+  DoFVariables** jointSetpointsReferences = jointMeasuresReferences + jointsNumber;
+  DoFVariables** axisMeasuresReferences = jointSetpointsReferences + jointsNumber;
+  DoFVariables** axisSetpointsReferences = axisMeasuresReferences + axesNumber;
+  
+  for( size_t jointIndex = 0; jointIndex < jointsNumber; jointIndex++ )
+  {
+    jointMeasuresReferences[ jointIndex ] = &(jointMeasuresList[ jointIndex ]);
+    jointSetpointsReferences[ jointIndex ] = &(jointSetpointsList[ jointIndex ]);
+  }
+  
+  for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+  {
+    axisMeasuresReferences[ axisIndex ] = &(axisMeasuresList[ axisIndex ]);
+    axisSetpointsReferences[ axisIndex ] = &(axisSetpointsList[ axisIndex ]);
+  }
+  
+  runControlStep( jointMeasuresReferences, axisMeasuresReferences, jointSetpointsReferences, axisSetpointsReferences, timeDelta );
+}
+
+/// Reference type for RunInstanceControlStep implementations, used to step batches on plugins not implementing ROBOT_CONTROL_BATCH_INTERFACE
+typedef void (*RunInstanceControlStepFunction)( RobotController, DoFVariables**, DoFVariables**, DoFVariables**, DoFVariables**, double );
+
+/// @brief Steps a batch of controller instances one by one, through a plugin RunInstanceControlStep implementation
+/// @param[in] runInstanceControlStep reference to loaded plugin RunInstanceControlStep implementation
+/// @param[in] stepsList list of per controller instance step arguments
+/// @param[in] stepsNumber number of elements in steps list
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+static inline void RunControlStepsBatchShim( RunInstanceControlStepFunction runInstanceControlStep, RobotControlStepData* stepsList, size_t stepsNumber, double timeDelta )
+{
+  for( size_t stepIndex = 0; stepIndex < stepsNumber; stepIndex++ )
+  {
+    RobotControlStepData* step = &(stepsList[ stepIndex ]);
+    runInstanceControlStep( step->controller, step->jointMeasuresList, step->axisMeasuresList, step->jointSetpointsList, step->axisSetpointsList, timeDelta );
+  }
+}
         
 #endif  // ROBOT_CONTROL_H
     
@@ -140,3 +418,211 @@ DoFVariables;
 /// @param[in,out] outputsList reference/pointer to list of addtional output values
 ///
 /// @memberof ROBOT_CONTROL_INTERFACE
+
+
+/// @class ROBOT_CONTROL_ARRAYS_INTERFACE
+/// @brief Optional robot control methods, for plugins that process per-field contiguous variable arrays
+///
+/// @memberof ROBOT_CONTROL_ARRAYS_INTERFACE
+/// @fn void RunControlStepArrays( DoFVariablesArrays* jointMeasures, DoFVariablesArrays* axisMeasures, DoFVariablesArrays* jointSetpoints, DoFVariablesArrays* axisSetpoints, double timeDelta )
+/// @brief Same as RunControlStep, but with each control variable of all joints/axes stored contiguously, allowing for vectorized per-field processing
+/// @param[in,out] jointMeasures per-field arrays of control variables representing current robot joints measures
+/// @param[in,out] axisMeasures per-field arrays of control variables representing current robot effector measures
+/// @param[in,out] jointSetpoints per-field arrays of control variables representing robot joints desired states
+/// @param[in,out] axisSetpoints per-field arrays of control variables representing robot effector desired states
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+///
+/// @memberof ROBOT_CONTROL_ARRAYS_INTERFACE
+
+
+/// @class ROBOT_CONTROL_CONTIGUOUS_INTERFACE
+/// @brief Optional robot control methods, for plugins that process contiguous variable lists without per degree-of-freedom references
+///
+/// @memberof ROBOT_CONTROL_CONTIGUOUS_INTERFACE
+/// @fn void RunControlStepContiguous( DoFVariables* jointMeasuresList, DoFVariables* jointSetpointsList, size_t jointsNumber, DoFVariables* axisMeasuresList, DoFVariables* axisSetpointsList, size_t axesNumber, double timeDelta )
+/// @brief Same as RunControlStep, but with variables of all joints/axes stored in contiguous lists. Hosts may fall back to RunControlStepContiguousShim for plugins not implementing it
+/// @param[in,out] jointMeasuresList contiguous list of control variables representing current robot joints measures
+/// @param[in,out] jointSetpointsList contiguous list of control variables representing robot joints desired states
+/// @param[in] jointsNumber number of elements in joint lists
+/// @param[in,out] axisMeasuresList contiguous list of control variables representing current robot effector measures
+/// @param[in,out] axisSetpointsList contiguous list of control variables representing robot effector desired states
+/// @param[in] axesNumber number of elements in axis lists
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+///
+/// @memberof ROBOT_CONTROL_CONTIGUOUS_INTERFACE
+
+
+/// @class ROBOT_CONTROL_MASKED_INTERFACE
+/// @brief Optional robot control methods, for plugins that skip processing of control variables that didn't change
+///
+/// @memberof ROBOT_CONTROL_MASKED_INTERFACE
+/// @fn void RunControlStepMasked( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, DoFChangesMask* jointMeasureChangesList, DoFChangesMask* axisMeasureChangesList, DoFChangesMask* jointSetpointChangesList, DoFChangesMask* axisSetpointChangesList, double timeDelta )
+/// @brief Same as RunControlStep, with additional per degree-of-freedom flags of which variables changed since the last call. Null changes lists mean all variables changed
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables representing current robot joints measures
+/// @param[in,out] axisMeasuresList list of per degree-of-freedom control variables representing current robot effector measures
+/// @param[in,out] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states
+/// @param[in,out] axisSetpointsList list of per degree-of-freedom control variables representing robot effector desired states
+/// @param[in,out] jointMeasureChangesList list of per joint measure changes, set by the plugin for updated variables
+/// @param[in,out] axisMeasureChangesList list of per axis measure changes, set by the plugin for updated variables
+/// @param[in,out] jointSetpointChangesList list of per joint setpoint changes, set by the caller for variables written since the last call
+/// @param[in,out] axisSetpointChangesList list of per axis setpoint changes, set by the caller for variables written since the last call
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+///
+/// @memberof ROBOT_CONTROL_MASKED_INTERFACE
+
+
+/// @class ROBOT_CONTROL_FLOAT_INTERFACE
+/// @brief Optional robot control methods, for plugins that process single precision control variables
+///
+/// @memberof ROBOT_CONTROL_FLOAT_INTERFACE
+/// @fn void RunControlStepFloat( FloatDoFVariables** jointMeasuresList, FloatDoFVariables** axisMeasuresList, FloatDoFVariables** jointSetpointsList, FloatDoFVariables** axisSetpointsList, double timeDelta )
+/// @brief Same as RunControlStep, with single precision variables. Hosts with double precision data may convert it with FloatDoFVariables_StoreList/LoadList
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables representing current robot joints measures
+/// @param[in,out] axisMeasuresList list of per degree-of-freedom control variables representing current robot effector measures
+/// @param[in,out] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states
+/// @param[in,out] axisSetpointsList list of per degree-of-freedom control variables representing robot effector desired states
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+///
+/// @memberof ROBOT_CONTROL_FLOAT_INTERFACE
+
+
+/// @class ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @brief Optional robot control methods, for plugins that keep per robot state in separate controller instances instead of process-global data
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn RobotController InitControllerInstance( const char* configurationString )
+/// @brief Creates and initializes new plugin specific robot controller instance
+/// @param[in] configurationString string containing the robot/plugin specific configuration
+/// @return reference to created controller instance on success, NULL otherwise
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn void EndControllerInstance( RobotController controller )
+/// @brief Deallocates data of given controller instance
+/// @param[in] controller reference to controller instance
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn size_t GetInstanceJointsNumber( RobotController controller )
+/// @brief Same as GetJointsNumber, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @return number of coordinates/degrees-of-freedom
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn const char** GetInstanceJointNamesList( RobotController controller )
+/// @brief Same as GetJointNamesList, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @return list of joint name strings
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn size_t GetInstanceAxesNumber( RobotController controller )
+/// @brief Same as GetAxesNumber, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @return number of coordinates/degrees-of-freedom
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn const char** GetInstanceAxisNamesList( RobotController controller )
+/// @brief Same as GetAxisNamesList, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @return list of effector axis name strings
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn void SetInstanceControlState( RobotController controller, enum ControlState controlState )
+/// @brief Same as SetControlState, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @param[in] controlState member of state enumeration
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn void RunInstanceControlStep( RobotController controller, DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+/// @brief Same as RunControlStep, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables representing current robot joints measures
+/// @param[in,out] axisMeasuresList list of per degree-of-freedom control variables representing current robot effector measures
+/// @param[in,out] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states
+/// @param[in,out] axisSetpointsList list of per degree-of-freedom control variables representing robot effector desired states
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn size_t GetInstanceExtraInputsNumber( RobotController controller )
+/// @brief Same as GetExtraInputsNumber, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @return number of additional inputs
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn void SetInstanceExtraInputsList( RobotController controller, double* inputsList )
+/// @brief Same as SetExtraInputsList, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @param[in] inputsList reference/pointer to list of addtional input values
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn size_t GetInstanceExtraOutputsNumber( RobotController controller )
+/// @brief Same as GetExtraOutputsNumber, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @return number of additional outputs
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+/// @fn void GetInstanceExtraOutputsList( RobotController controller, double* outputsList )
+/// @brief Same as GetExtraOutputsList, for given controller instance
+/// @param[in] controller reference to controller instance
+/// @param[in,out] outputsList reference/pointer to list of addtional output values
+///
+/// @memberof ROBOT_CONTROL_INSTANCE_INTERFACE
+
+
+/// @class ROBOT_CONTROL_BATCH_INTERFACE
+/// @brief Optional robot control methods, for plugins that process control steps of many controller instances at once
+///
+/// @memberof ROBOT_CONTROL_BATCH_INTERFACE
+/// @fn void RunControlStepsBatch( RobotControlStepData* stepsList, size_t stepsNumber, double timeDelta )
+/// @brief Same as calling RunInstanceControlStep for each given instance, leaving the plugin free to interleave/vectorize their processing. Hosts may fall back to RunControlStepsBatchShim for plugins not implementing it
+/// @param[in,out] stepsList list of per controller instance step arguments (instance reference and variables lists)
+/// @param[in] stepsNumber number of elements in steps list
+/// @param[in] timeDelta time (in seconds) since the last control pass was called, common for all instances
+///
+/// @memberof ROBOT_CONTROL_BATCH_INTERFACE
+
+
+/// @class ROBOT_CONTROL_MULTIRATE_INTERFACE
+/// @brief Optional robot control methods, for plugins that split RunControlStep in joint level control and joint/axis coordinate conversion passes, to be called at different rates (see control_loop.h)
+///
+/// @memberof ROBOT_CONTROL_MULTIRATE_INTERFACE
+/// @fn void RunJointControlStep( DoFVariables** jointMeasuresList, DoFVariables** jointSetpointsList, double timeDelta )
+/// @brief Calls plugin specific logic to process single joint level control pass (usually at a higher rate)
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables representing current robot joints measures
+/// @param[in,out] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states
+/// @param[in] timeDelta time (in seconds) since the last joint control pass was called
+///
+/// @memberof ROBOT_CONTROL_MULTIRATE_INTERFACE
+/// @fn void RunAxisControlStep( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+/// @brief Calls plugin specific logic to process single axis level control pass and joints/axes coordinate conversions (usually at a lower rate)
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables representing current robot joints measures
+/// @param[in,out] axisMeasuresList list of per degree-of-freedom control variables representing current robot effector measures
+/// @param[in,out] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states
+/// @param[in,out] axisSetpointsList list of per degree-of-freedom control variables representing robot effector desired states
+/// @param[in] timeDelta time (in seconds) since the last axis control pass was called
+///
+/// @memberof ROBOT_CONTROL_MULTIRATE_INTERFACE
+
+
+/// @class ROBOT_CONTROL_PHASES_INTERFACE
+/// @brief Optional robot control methods, for plugins that split RunControlStep in device input, control computation and device output phases.
+/// Hosts may run input/output phases concurrently with computation of another cycle (see control_loop.h), so they shouldn't share unprotected plugin state
+///
+/// @memberof ROBOT_CONTROL_PHASES_INTERFACE
+/// @fn void ReadMeasures( DoFVariables** jointMeasuresList )
+/// @brief Reads current robot joints measures from the device
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables to be updated with current robot joints measures
+///
+/// @memberof ROBOT_CONTROL_PHASES_INTERFACE
+/// @fn void ComputeControl( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+/// @brief Calls plugin specific logic to process single control pass and joints/axes coordinate conversions, without device access
+/// @param[in,out] jointMeasuresList list of per degree-of-freedom control variables representing robot joints measures, as read by ReadMeasures
+/// @param[in,out] axisMeasuresList list of per degree-of-freedom control variables representing current robot effector measures
+/// @param[in,out] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states, to be written by WriteSetpoints
+/// @param[in,out] axisSetpointsList list of per degree-of-freedom control variables representing robot effector desired states
+/// @param[in] timeDelta time (in seconds) since the last control pass was called
+///
+/// @memberof ROBOT_CONTROL_PHASES_INTERFACE
+/// @fn void WriteSetpoints( DoFVariables** jointSetpointsList )
+/// @brief Writes robot joints setpoints to the device
+/// @param[in] jointSetpointsList list of per degree-of-freedom control variables representing robot joints desired states
+///
+/// @memberof ROBOT_CONTROL_PHASES_INTERFACE
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file robot_control.hpp
+/// @brief C++ static dispatch wrapper for statically linked robot control plugins
+///
+/// Plugins built with ROBOT_CONTROL_STATIC_PLUGINS CMake option (see add_robot_control_plugin) are static libraries whose
+/// interface functions are prefixed with the plugin name. Calls through RobotControl<Plugin> bind directly to those symbols,
+/// allowing for inlining and link time optimization of the whole control loop
+
+#ifndef ROBOT_CONTROL_HPP
+#define ROBOT_CONTROL_HPP
+
+extern "C"
+{
+  #include "robot_control.h"
+}
+
+/// Interface function declaration with plugin name prefix, used by DECLARE_STATIC_ROBOT_CONTROL_PLUGIN
+#define STATIC_PLUGIN_FUNCTION_DECLARATION( rtype, Interface, name, ... ) rtype Interface##_##name( __VA_ARGS__ );
+/// Compile time constant reference to interface function with plugin name prefix, used by DECLARE_STATIC_ROBOT_CONTROL_PLUGIN
+#define STATIC_PLUGIN_FUNCTION_REFERENCE( rtype, Interface, name, ... ) static constexpr rtype (*name)( __VA_ARGS__ ) = Interface##_##name;
+
+/// Declares prefixed interface functions of a statically linked plugin and a PluginName type binding them, to be used as RobotControl template argument
+#define DECLARE_STATIC_ROBOT_CONTROL_PLUGIN( PluginName ) \
+        extern "C" { ROBOT_CONTROL_INTERFACE( PluginName, STATIC_PLUGIN_FUNCTION_DECLARATION ) } \
+        struct PluginName { ROBOT_CONTROL_INTERFACE( PluginName, STATIC_PLUGIN_FUNCTION_REFERENCE ) };
+
+/// @brief Statically dispatched robot control interface
+/// @tparam Plugin type declared with DECLARE_STATIC_ROBOT_CONTROL_PLUGIN for the linked plugin
+///
+/// Same methods as ROBOT_CONTROL_INTERFACE, resolved at compile time
+template< typename Plugin >
+class RobotControl
+{
+public:
+  static inline bool InitController( const char* configurationString ) { return Plugin::InitController( configurationString ); }
+  static inline void EndController( void ) { Plugin::EndController(); }
+  static inline size_t GetJointsNumber( void ) { return Plugin::GetJointsNumber(); }
+  static inline const char** GetJointNamesList( void ) { return Plugin::GetJointNamesList(); }
+  static inline size_t GetAxesNumber( void ) { return Plugin::GetAxesNumber(); }
+  static inline const char** GetAxisNamesList( void ) { return Plugin::GetAxisNamesList(); }
+  static inline void SetControlState( enum ControlState controlState ) { Plugin::SetControlState( controlState ); }
+  static inline void RunControlStep( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, 
+                                     DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+  {
+    Plugin::RunControlStep( jointMeasuresList, axisMeasuresList, jointSetpointsList, axisSetpointsList, timeDelta );
+  }
+  static inline size_t GetExtraInputsNumber( void ) { return Plugin::GetExtraInputsNumber(); }
+  static inline void SetExtraInputsList( double* inputsList ) { Plugin::SetExtraInputsList( inputsList ); }
+  static inline size_t GetExtraOutputsNumber( void ) { return Plugin::GetExtraOutputsNumber(); }
+  static inline void GetExtraOutputsList( double* outputsList ) { Plugin::GetExtraOutputsList( outputsList ); }
+};
+
+#endif  // ROBOT_CONTROL_HPP
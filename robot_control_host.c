@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+/// @file robot_control_host.c
+/// @brief Isolated robot control plugin host process
+///
+/// Started by PluginHost_Start (plugin_host.h) as "robot_control_host <bridge fd> <plugin path>": loads the plugin library and runs 
+/// its ROBOT_CONTROL_INTERFACE functions on behalf of the client process, through the shared memory bridge inherited as a file descriptor
+
+#define _GNU_SOURCE
+
+#include "plugin_bridge.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define CLIENT_CHECK_INTERVAL_NS 100000000LL
+
+#define LOAD_FUNCTION( rtype, Interface, name, ... ) \
+        if( ( *((void**) &(plugin.name)) = dlsym( library, #name ) ) == NULL ) { fprintf( stderr, "robot_control_host: %s not found\n", #name ); return false; }
+
+static RobotControlFunctions plugin;
+static DoFVariables* jointMeasuresList[ PLUGIN_BRIDGE_MAX_DOFS ];
+static DoFVariables* axisMeasuresList[ PLUGIN_BRIDGE_MAX_DOFS ];
+static DoFVariables* jointSetpointsList[ PLUGIN_BRIDGE_MAX_DOFS ];
+static DoFVariables* axisSetpointsList[ PLUGIN_BRIDGE_MAX_DOFS ];
+
+static bool LoadPlugin( const char* pluginPath )
+{
+  void* library = dlopen( pluginPath, RTLD_NOW );
+  if( library == NULL )
+  {
+    fprintf( stderr, "robot_control_host: %s\n", dlerror() );
+    return false;
+  }
+  
+  ROBOT_CONTROL_INTERFACE( , LOAD_FUNCTION )
+  
+  return true;
+}
+
+static void CopyNames( PluginBridge* bridge, const char** namesList, size_t namesNumber )
+{
+  bridge->hasNames = ( namesList != NULL );
+  if( namesList == NULL ) return;
+  
+  for( size_t nameIndex = 0; nameIndex < namesNumber && nameIndex < PLUGIN_BRIDGE_MAX_DOFS; nameIndex++ )
+  {
+    strncpy( bridge->namesList[ nameIndex ], ( namesList[ nameIndex ] != NULL ) ? namesList[ nameIndex ] : "", PLUGIN_BRIDGE_NAME_LENGTH - 1 );
+    bridge->namesList[ nameIndex ][ PLUGIN_BRIDGE_NAME_LENGTH - 1 ] = '\0';
+  }
+}
+
+static bool InitController( PluginBridge* bridge )
+{
+  bridge->configuration[ PLUGIN_BRIDGE_CONFIG_LENGTH - 1 ] = '\0';
+  if( !plugin.InitController( bridge->configuration ) ) return false;
+  
+  size_t jointsNumber = plugin.GetJointsNumber();
+  size_t axesNumber = plugin.GetAxesNumber();
+  size_t extraInputsNumber = plugin.GetExtraInputsNumber();
+  size_t extraOutputsNumber = plugin.GetExtraOutputsNumber();
+  if( jointsNumber > PLUGIN_BRIDGE_MAX_DOFS || axesNumber > PLUGIN_BRIDGE_MAX_DOFS 
+      || extraInputsNumber > PLUGIN_BRIDGE_MAX_EXTRAS || extraOutputsNumber > PLUGIN_BRIDGE_MAX_EXTRAS )
+  {
+    fputs( "robot_control_host: plugin variables exceed bridge capacity\n", stderr );
+    plugin.EndController();
+    return false;
+  }
+  
+  bridge->jointsNumber = (uint32_t) jointsNumber;
+  bridge->axesNumber = (uint32_t) axesNumber;
+  bridge->extraInputsNumber = (uint32_t) extraInputsNumber;
+  bridge->extraOutputsNumber = (uint32_t) extraOutputsNumber;
+  
+  return true;
+}
+
+static bool RunCall( PluginBridge* bridge )
+{
+  switch( bridge->call )
+  {
+    case PLUGIN_BRIDGE_InitController: bridge->returnValue = InitController( bridge ); break;
+    case PLUGIN_BRIDGE_EndController: plugin.EndController(); break;
+    case PLUGIN_BRIDGE_GetJointsNumber: bridge->returnValue = (uint32_t) plugin.GetJointsNumber(); break;
+    case PLUGIN_BRIDGE_GetJointNamesList: CopyNames( bridge, plugin.GetJointNamesList(), bridge->jointsNumber ); break;
+    case PLUGIN_BRIDGE_GetAxesNumber: bridge->returnValue = (uint32_t) plugin.GetAxesNumber(); break;
+    case PLUGIN_BRIDGE_GetAxisNamesList: CopyNames( bridge, plugin.GetAxisNamesList(), bridge->axesNumber ); break;
+    case PLUGIN_BRIDGE_SetControlState: plugin.SetControlState( (enum ControlState) bridge->controlState ); break;
+    case PLUGIN_BRIDGE_RunControlStep: 
+      plugin.RunControlStep( jointMeasuresList, axisMeasuresList, jointSetpointsList, axisSetpointsList, bridge->timeDelta ); break;
+    case PLUGIN_BRIDGE_GetExtraInputsNumber: bridge->returnValue = (uint32_t) plugin.GetExtraInputsNumber(); break;
+    case PLUGIN_BRIDGE_SetExtraInputsList: plugin.SetExtraInputsList( bridge->extrasList ); break;
+    case PLUGIN_BRIDGE_GetExtraOutputsNumber: bridge->returnValue = (uint32_t) plugin.GetExtraOutputsNumber(); break;
+    case PLUGIN_BRIDGE_GetExtraOutputsList: plugin.GetExtraOutputsList( bridge->extrasList ); break;
+    default: return false;
+  }
+  
+  return true;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 3 )
+  {
+    fputs( "usage: robot_control_host <bridge fd> <plugin path>\n", stderr );
+    return EXIT_FAILURE;
+  }
+  
+  pid_t clientPID = getppid();
+  
+  int bridgeFD = atoi( argv[ 1 ] );
+  PluginBridge* bridge = (PluginBridge*) mmap( NULL, sizeof(PluginBridge), PROT_READ | PROT_WRITE, MAP_SHARED, bridgeFD, 0 );
+  close( bridgeFD );
+  if( bridge == MAP_FAILED ) return EXIT_FAILURE;
+  
+  if( !LoadPlugin( argv[ 2 ] ) ) return EXIT_FAILURE;
+  
+  for( size_t dofIndex = 0; dofIndex < PLUGIN_BRIDGE_MAX_DOFS; dofIndex++ )
+  {
+    jointMeasuresList[ dofIndex ] = &(bridge->jointMeasuresList[ dofIndex ]);
+    axisMeasuresList[ dofIndex ] = &(bridge->axisMeasuresList[ dofIndex ]);
+    jointSetpointsList[ dofIndex ] = &(bridge->jointSetpointsList[ dofIndex ]);
+    axisSetpointsList[ dofIndex ] = &(bridge->axisSetpointsList[ dofIndex ]);
+  }
+  
+  mlockall( MCL_CURRENT | MCL_FUTURE );
+  
+  while( true )
+  {
+    // Host must not outlive its client (which becomes reparented)
+    if( !PluginBridge_WaitState( bridge, PLUGIN_BRIDGE_CALL, CLIENT_CHECK_INTERVAL_NS ) )
+    {
+      if( getppid() != clientPID ) break;
+      continue;
+    }
+    bool isRunning = RunCall( bridge );
+    PluginBridge_SetState( bridge, PLUGIN_BRIDGE_RETURN );
+    if( !isRunning ) break;
+  }
+  
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "robot_control_registry.h"
+
+#include <string.h>
+
+// Generated by add_robot_control_registry, with a ROBOT_CONTROL_REGISTRY_ENTRY( PluginName ) line for each registered plugin
+#define ROBOT_CONTROL_REGISTRY_ENTRIES "robot_control_registry_entries.h"
+
+#define PREFIXED_FUNCTION_DECLARATION( rtype, Interface, name, ... ) rtype Interface##_##name( __VA_ARGS__ );
+#define PREFIXED_FUNCTION_REFERENCE( rtype, Interface, name, ... ) .name = Interface##_##name,
+
+typedef struct RegistryEntry
+{
+  const char* name;
+  RobotControlFunctions functions;
+}
+RegistryEntry;
+
+#define ROBOT_CONTROL_REGISTRY_ENTRY( PluginName ) ROBOT_CONTROL_INTERFACE( PluginName, PREFIXED_FUNCTION_DECLARATION )
+#include ROBOT_CONTROL_REGISTRY_ENTRIES
+#undef ROBOT_CONTROL_REGISTRY_ENTRY
+
+#define ROBOT_CONTROL_REGISTRY_ENTRY( PluginName ) { .name = #PluginName, .functions = { ROBOT_CONTROL_INTERFACE( PluginName, PREFIXED_FUNCTION_REFERENCE ) } },
+static const RegistryEntry REGISTRY[] = 
+{
+  #include ROBOT_CONTROL_REGISTRY_ENTRIES
+  { .name = NULL }
+};
+#undef ROBOT_CONTROL_REGISTRY_ENTRY
+
+static const size_t REGISTRY_SIZE = sizeof(REGISTRY) / sizeof(RegistryEntry) - 1;
+
+
+size_t RobotControlRegistry_GetPluginsNumber( void )
+{
+  return REGISTRY_SIZE;
+}
+
+const char* RobotControlRegistry_GetPluginName( size_t pluginIndex )
+{
+  if( pluginIndex >= REGISTRY_SIZE ) return NULL;
+  
+  return REGISTRY[ pluginIndex ].name;
+}
+
+const RobotControlFunctions* RobotControlRegistry_GetPlugin( const char* pluginName )
+{
+  if( pluginName == NULL ) return NULL;
+  
+  for( size_t pluginIndex = 0; pluginIndex < REGISTRY_SIZE; pluginIndex++ )
+  {
+    if( strcmp( REGISTRY[ pluginIndex ].name, pluginName ) == 0 ) return &(REGISTRY[ pluginIndex ].functions);
+  }
+  
+  return NULL;
+}
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file robot_control_registry.h
+/// @brief Link time registry of statically linked robot control plugins
+///
+/// Registry libraries are generated by add_robot_control_registry CMake function, from plugins built with ROBOT_CONTROL_STATIC_PLUGINS option,
+/// allowing hosts to select plugins by name without runtime library loading
+
+#ifndef ROBOT_CONTROL_REGISTRY_H
+#define ROBOT_CONTROL_REGISTRY_H
+
+#include "robot_control.h"
+
+/// @brief Gets number of plugins linked into the registry
+/// @return number of registered plugins
+size_t RobotControlRegistry_GetPluginsNumber( void );
+
+/// @brief Gets name of registered plugin
+/// @param[in] pluginIndex index of plugin in the registry (from 0 to number of plugins - 1)
+/// @return plugin name string on success, NULL for invalid index
+const char* RobotControlRegistry_GetPluginName( size_t pluginIndex );
+
+/// @brief Gets interface functions of registered plugin
+/// @param[in] pluginName name of plugin given to add_robot_control_plugin
+/// @return reference to table of plugin interface functions on success, NULL if plugin was not registered
+const RobotControlFunctions* RobotControlRegistry_GetPlugin( const char* pluginName );
+
+#endif  // ROBOT_CONTROL_REGISTRY_H
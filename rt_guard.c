@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "rt_guard.h"
+
+#include <alloca.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_STACK_PREFAULT_SIZE ( 256 * 1024 )
+#define MAX_CALL_STACK_DEPTH 32
+
+// Glibc allocator entry points, used by interposed allocation functions without symbol lookup (which allocates itself)
+extern void* __libc_malloc( size_t );
+extern void* __libc_calloc( size_t, size_t );
+extern void* __libc_realloc( void*, size_t );
+extern void __libc_free( void* );
+extern void* __libc_memalign( size_t, size_t );
+
+// Initial exec TLS model avoids allocating (and recursing into malloc) on first access
+static _Thread_local bool isStepRunning __attribute__(( tls_model( "initial-exec" ) )) = false;
+static _Thread_local bool isReporting __attribute__(( tls_model( "initial-exec" ) )) = false;
+
+static atomic_int guardAction = RT_GUARD_REPORT;
+static atomic_uint_fast64_t violationsCount = 0;
+
+// Gets next (real) definition of interposed function, looked up on first call
+#define GET_REAL_FUNCTION( type, name ) \
+  static _Atomic( type ) real_##name = NULL; \
+  if( atomic_load_explicit( &real_##name, memory_order_relaxed ) == NULL ) atomic_store( &real_##name, (type) dlsym( RTLD_NEXT, #name ) );
+
+static void CheckCall( const char* functionName )
+{
+  if( !isStepRunning || isReporting ) return;
+  
+  isReporting = true;
+  atomic_fetch_add_explicit( &violationsCount, 1, memory_order_relaxed );
+  
+  // Message formatting and output avoid interposed (and allocating) functions
+  char message[ 128 ];
+  int messageLength = snprintf( message, sizeof(message), "RT guard: %s called during control step\n", functionName );
+  if( messageLength > 0 ) write( STDERR_FILENO, message, ( (size_t) messageLength < sizeof(message) ) ? (size_t) messageLength : sizeof(message) - 1 );
+  void* callStack[ MAX_CALL_STACK_DEPTH ];
+  int callStackDepth = backtrace( callStack, MAX_CALL_STACK_DEPTH );
+  if( callStackDepth > 2 ) backtrace_symbols_fd( callStack + 2, callStackDepth - 2, STDERR_FILENO );
+  
+  if( atomic_load_explicit( &guardAction, memory_order_relaxed ) == RT_GUARD_ABORT ) abort();
+  
+  isReporting = false;
+}
+
+void RTGuard_SetAction( enum RTGuardAction action )
+{
+  atomic_store( &guardAction, action );
+}
+
+static __attribute__(( noinline )) void PrefaultStack( size_t stackPrefaultSize )
+{
+  volatile uint8_t* stackBuffer = (volatile uint8_t*) alloca( stackPrefaultSize );
+  long pageSize = sysconf( _SC_PAGESIZE );
+  for( size_t offset = 0; offset < stackPrefaultSize; offset += (size_t) pageSize )
+    stackBuffer[ offset ] = 0;
+}
+
+bool RTGuard_PrepareThread( size_t stackPrefaultSize )
+{
+  // First backtrace call loads the unwinder library, which should happen now rather than on a control step
+  void* callStack[ 1 ];
+  backtrace( callStack, 1 );
+  
+  bool isMemoryLocked = ( mlockall( MCL_CURRENT | MCL_FUTURE ) == 0 );
+  if( !isMemoryLocked ) fputs( "RT guard: could not lock process memory (mlockall)\n", stderr );
+  
+  PrefaultStack( ( stackPrefaultSize > 0 ) ? stackPrefaultSize : DEFAULT_STACK_PREFAULT_SIZE );
+  
+  return isMemoryLocked;
+}
+
+void RTGuard_EnterStep( void )
+{
+  isStepRunning = true;
+}
+
+void RTGuard_ExitStep( void )
+{
+  isStepRunning = false;
+}
+
+uint64_t RTGuard_GetViolationsCount( void )
+{
+  return atomic_load_explicit( &violationsCount, memory_order_relaxed );
+}
+
+// Memory allocation
+
+void* malloc( size_t size )
+{
+  CheckCall( "malloc" );
+  return __libc_malloc( size );
+}
+
+void* calloc( size_t elementsNumber, size_t elementSize )
+{
+  CheckCall( "calloc" );
+  return __libc_calloc( elementsNumber, elementSize );
+}
+
+void* realloc( void* data, size_t size )
+{
+  CheckCall( "realloc" );
+  return __libc_realloc( data, size );
+}
+
+void free( void* data )
+{
+  if( data != NULL ) CheckCall( "free" );
+  __libc_free( data );
+}
+
+void* aligned_alloc( size_t alignment, size_t size )
+{
+  CheckCall( "aligned_alloc" );
+  return __libc_memalign( alignment, size );
+}
+
+int posix_memalign( void** dataReference, size_t alignment, size_t size )
+{
+  CheckCall( "posix_memalign" );
+  if( alignment < sizeof(void*) || ( alignment & ( alignment - 1 ) ) != 0 ) return EINVAL;
+  *dataReference = __libc_memalign( alignment, size );
+  return ( *dataReference != NULL ) ? 0 : ENOMEM;
+}
+
+// Blocking synchronization and sleeps
+
+int pthread_mutex_lock( pthread_mutex_t* mutex )
+{
+  GET_REAL_FUNCTION( int (*)( pthread_mutex_t* ), pthread_mutex_lock );
+  CheckCall( "pthread_mutex_lock" );
+  return real_pthread_mutex_lock( mutex );
+}
+
+int pthread_cond_wait( pthread_cond_t* condition, pthread_mutex_t* mutex )
+{
+  GET_REAL_FUNCTION( int (*)( pthread_cond_t*, pthread_mutex_t* ), pthread_cond_wait );
+  CheckCall( "pthread_cond_wait" );
+  return real_pthread_cond_wait( condition, mutex );
+}
+
+int nanosleep( const struct timespec* duration, struct timespec* remainingTime )
+{
+  GET_REAL_FUNCTION( int (*)( const struct timespec*, struct timespec* ), nanosleep );
+  CheckCall( "nanosleep" );
+  return real_nanosleep( duration, remainingTime );
+}
+
+int usleep( useconds_t duration )
+{
+  GET_REAL_FUNCTION( int (*)( useconds_t ), usleep );
+  CheckCall( "usleep" );
+  return real_usleep( duration );
+}
+
+unsigned int sleep( unsigned int duration )
+{
+  GET_REAL_FUNCTION( unsigned int (*)( unsigned int ), sleep );
+  CheckCall( "sleep" );
+  return real_sleep( duration );
+}
+
+// File opening
+
+int open( const char* path, int flags, ... )
+{
+  GET_REAL_FUNCTION( int (*)( const char*, int, ... ), open );
+  CheckCall( "open" );
+  va_list arguments;
+  va_start( arguments, flags );
+  mode_t mode = ( flags & ( O_CREAT | O_TMPFILE ) ) ? va_arg( arguments, mode_t ) : 0;
+  va_end( arguments );
+  return real_open( path, flags, mode );
+}
+
+FILE* fopen( const char* path, const char* mode )
+{
+  GET_REAL_FUNCTION( FILE* (*)( const char*, const char* ), fopen );
+  CheckCall( "fopen" );
+  return real_fopen( path, mode );
+}
+
+// Standard output printing (including fortified variants used with _FORTIFY_SOURCE)
+
+int printf( const char* format, ... )
+{
+  GET_REAL_FUNCTION( int (*)( const char*, va_list ), vprintf );
+  CheckCall( "printf" );
+  va_list arguments;
+  va_start( arguments, format );
+  int result = real_vprintf( format, arguments );
+  va_end( arguments );
+  return result;
+}
+
+int __printf_chk( int flag, const char* format, ... )
+{
+  GET_REAL_FUNCTION( int (*)( int, const char*, va_list ), __vprintf_chk );
+  CheckCall( "printf" );
+  va_list arguments;
+  va_start( arguments, format );
+  int result = real___vprintf_chk( flag, format, arguments );
+  va_end( arguments );
+  return result;
+}
+
+int fprintf( FILE* stream, const char* format, ... )
+{
+  GET_REAL_FUNCTION( int (*)( FILE*, const char*, va_list ), vfprintf );
+  CheckCall( "fprintf" );
+  va_list arguments;
+  va_start( arguments, format );
+  int result = real_vfprintf( stream, format, arguments );
+  va_end( arguments );
+  return result;
+}
+
+int __fprintf_chk( FILE* stream, int flag, const char* format, ... )
+{
+  GET_REAL_FUNCTION( int (*)( FILE*, int, const char*, va_list ), __vfprintf_chk );
+  CheckCall( "fprintf" );
+  va_list arguments;
+  va_start( arguments, format );
+  int result = real___vfprintf_chk( stream, flag, format, arguments );
+  va_end( arguments );
+  return result;
+}
+
+int puts( const char* text )
+{
+  GET_REAL_FUNCTION( int (*)( const char* ), puts );
+  CheckCall( "puts" );
+  return real_puts( text );
+}
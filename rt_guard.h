@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file rt_guard.h
+/// @brief Real-time safety debug guard for plugin control steps
+///
+/// When the RobotControlGuard shared library is linked to (or preloaded into) a host, memory allocation and selected blocking calls
+/// (mutex locks, sleeps, file opening and standard output printing) made by a thread while it runs a control step are reported with
+/// their call stack. Control loop and fleet executors mark their steps and prepare their threads automatically when the library is present.
+/// As the guard stores its thread state in static TLS, the library must be loaded at program start (not through dlopen)
+
+#ifndef RT_GUARD_H
+#define RT_GUARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Actions taken by guard on non real-time safe calls during control steps
+enum RTGuardAction 
+{ 
+  RT_GUARD_REPORT,            ///< Print offending call and its stack to standard error and carry on
+  RT_GUARD_ABORT              ///< Print offending call and its stack to standard error and abort the process (for certification runs)
+};
+
+/// @brief Sets action taken by guard on non real-time safe calls (RT_GUARD_REPORT by default)
+/// @param[in] action action to be taken on all threads
+void RTGuard_SetAction( enum RTGuardAction action );
+
+/// @brief Locks process memory (current and future pages) and prefaults calling thread stack, to prevent page faults on later control steps
+/// @param[in] stackPrefaultSize number of stack bytes to be touched (must be lower than thread stack size), or 0 for default (256 KiB)
+/// @return true if memory could be locked, false otherwise (e.g. lacking CAP_IPC_LOCK or RLIMIT_MEMLOCK)
+bool RTGuard_PrepareThread( size_t stackPrefaultSize );
+
+/// @brief Marks start of control step on calling thread, from which non real-time safe calls are reported
+void RTGuard_EnterStep( void );
+
+/// @brief Marks end of control step on calling thread
+void RTGuard_ExitStep( void );
+
+/// @brief Gets total number of non real-time safe calls detected during control steps
+/// @return number of reported calls, on all threads
+uint64_t RTGuard_GetViolationsCount( void );
+
+#endif  // RT_GUARD_H
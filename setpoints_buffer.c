@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "setpoints_buffer.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOTS_NUMBER 3                  // Reader, writer and shared (middle) setpoint sets
+#define SLOT_INDEX_MASK 0x03
+#define SLOT_NEW_FLAG 0x04              // Set when shared slot holds a set not yet taken by the reader
+
+typedef struct SetpointsSlot
+{
+  DoFVariables* variablesList;
+  DoFVariables** jointsList;
+  DoFVariables** axesList;
+}
+SetpointsSlot;
+
+struct _SetpointsBufferData
+{
+  size_t jointsNumber, axesNumber;
+  SetpointsSlot stagingSlot;            // Writer private set, persistent between publications
+  SetpointsSlot slotsList[ SLOTS_NUMBER ];
+  atomic_uint sharedState;              // Shared slot index and new data flag
+  unsigned int writeIndex, readIndex;
+};
+
+
+static bool InitSlot( SetpointsSlot* slot, size_t jointsNumber, size_t axesNumber )
+{
+  size_t dofsNumber = jointsNumber + axesNumber;
+  // Plugins without joints and axes get empty (NULL) lists, as allocations of 0 elements may fail
+  if( dofsNumber == 0 ) return true;
+  
+  slot->variablesList = (DoFVariables*) calloc( dofsNumber, sizeof(DoFVariables) );
+  slot->jointsList = (DoFVariables**) calloc( dofsNumber, sizeof(DoFVariables*) );
+  if( slot->variablesList == NULL || slot->jointsList == NULL ) return false;
+  
+  slot->axesList = slot->jointsList + jointsNumber;
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+    slot->jointsList[ dofIndex ] = &(slot->variablesList[ dofIndex ]);
+  
+  return true;
+}
+
+static void EndSlot( SetpointsSlot* slot )
+{
+  free( slot->variablesList );
+  free( slot->jointsList );
+}
+
+SetpointsBuffer SetpointsBuffer_Create( size_t jointsNumber, size_t axesNumber )
+{
+  SetpointsBuffer newBuffer = (SetpointsBuffer) calloc( 1, sizeof(SetpointsBufferData) );
+  if( newBuffer == NULL ) return NULL;
+  
+  newBuffer->jointsNumber = jointsNumber;
+  newBuffer->axesNumber = axesNumber;
+  
+  bool success = InitSlot( &(newBuffer->stagingSlot), jointsNumber, axesNumber );
+  for( size_t slotIndex = 0; slotIndex < SLOTS_NUMBER; slotIndex++ )
+    success = InitSlot( &(newBuffer->slotsList[ slotIndex ]), jointsNumber, axesNumber ) && success;
+  
+  if( !success )
+  {
+    SetpointsBuffer_Discard( newBuffer );
+    return NULL;
+  }
+  
+  newBuffer->writeIndex = 0;
+  atomic_init( &(newBuffer->sharedState), 1 );
+  newBuffer->readIndex = 2;
+  
+  return newBuffer;
+}
+
+void SetpointsBuffer_Discard( SetpointsBuffer buffer )
+{
+  if( buffer == NULL ) return;
+  
+  EndSlot( &(buffer->stagingSlot) );
+  for( size_t slotIndex = 0; slotIndex < SLOTS_NUMBER; slotIndex++ )
+    EndSlot( &(buffer->slotsList[ slotIndex ]) );
+  
+  free( buffer );
+}
+
+DoFVariables** SetpointsBuffer_GetJointWriteList( SetpointsBuffer buffer )
+{
+  return buffer->stagingSlot.jointsList;
+}
+
+DoFVariables** SetpointsBuffer_GetAxisWriteList( SetpointsBuffer buffer )
+{
+  return buffer->stagingSlot.axesList;
+}
+
+void SetpointsBuffer_Publish( SetpointsBuffer buffer )
+{
+  // Staging data is copied so that the writer keeps a complete set to modify, even after the published slot is taken by the reader
+  SetpointsSlot* writeSlot = &(buffer->slotsList[ buffer->writeIndex ]);
+  size_t dofsNumber = buffer->jointsNumber + buffer->axesNumber;
+  if( dofsNumber > 0 ) memcpy( writeSlot->variablesList, buffer->stagingSlot.variablesList, dofsNumber * sizeof(DoFVariables) );
+  
+  unsigned int oldState = atomic_exchange_explicit( &(buffer->sharedState), buffer->writeIndex | SLOT_NEW_FLAG, memory_order_acq_rel );
+  buffer->writeIndex = oldState & SLOT_INDEX_MASK;
+}
+
+bool SetpointsBuffer_Update( SetpointsBuffer buffer )
+{
+  if( !( atomic_load_explicit( &(buffer->sharedState), memory_order_relaxed ) & SLOT_NEW_FLAG ) ) return false;
+  
+  unsigned int oldState = atomic_exchange_explicit( &(buffer->sharedState), buffer->readIndex, memory_order_acq_rel );
+  buffer->readIndex = oldState & SLOT_INDEX_MASK;
+  
+  return true;
+}
+
+DoFVariables** SetpointsBuffer_GetJointReadList( SetpointsBuffer buffer )
+{
+  return buffer->slotsList[ buffer->readIndex ].jointsList;
+}
+
+DoFVariables** SetpointsBuffer_GetAxisReadList( SetpointsBuffer buffer )
+{
+  return buffer->slotsList[ buffer->readIndex ].axesList;
+}
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file setpoints_buffer.h
+/// @brief Lock-free (triple buffer) handoff of robot setpoints between application and control threads
+///
+/// A single writer thread (e.g. motion planner) fills complete joint/axis setpoint lists and publishes them, while a single reader thread
+/// (the one calling RunControlStep) picks the latest published set, with neither of them ever blocking or seeing partially written data
+
+#ifndef SETPOINTS_BUFFER_H
+#define SETPOINTS_BUFFER_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+
+/// Opaque setpoints buffer data
+typedef struct _SetpointsBufferData SetpointsBufferData;
+/// Opaque reference to setpoints buffer
+typedef SetpointsBufferData* SetpointsBuffer;
+
+/// @brief Creates setpoints buffer for given numbers of degrees-of-freedom (usually from plugin GetJointsNumber and GetAxesNumber)
+/// @param[in] jointsNumber number of joint setpoints in each set (may be 0)
+/// @param[in] axesNumber number of axis setpoints in each set (may be 0)
+/// @return reference to created buffer on success, NULL otherwise
+SetpointsBuffer SetpointsBuffer_Create( size_t jointsNumber, size_t axesNumber );
+
+/// @brief Deallocates data of given setpoints buffer
+/// @param[in] buffer reference to setpoints buffer
+void SetpointsBuffer_Discard( SetpointsBuffer buffer );
+
+/// @brief Gets writer side list of joint setpoints, kept between publications (writer thread only)
+/// @param[in] buffer reference to setpoints buffer
+/// @return list of per degree-of-freedom joint setpoints to be written
+DoFVariables** SetpointsBuffer_GetJointWriteList( SetpointsBuffer buffer );
+
+/// @brief Gets writer side list of axis setpoints, kept between publications (writer thread only)
+/// @param[in] buffer reference to setpoints buffer
+/// @return list of per degree-of-freedom axis setpoints to be written
+DoFVariables** SetpointsBuffer_GetAxisWriteList( SetpointsBuffer buffer );
+
+/// @brief Makes current writer side setpoints available to the reader, as a complete set (writer thread only)
+/// @param[in] buffer reference to setpoints buffer
+void SetpointsBuffer_Publish( SetpointsBuffer buffer );
+
+/// @brief Swaps reader side lists for the latest published set, if any (reader thread only, wait-free)
+/// @param[in] buffer reference to setpoints buffer
+/// @return true if a new set was published since the last update, false otherwise (keeping current reader lists)
+bool SetpointsBuffer_Update( SetpointsBuffer buffer );
+
+/// @brief Gets reader side list of joint setpoints, valid until next update (reader thread only)
+/// @param[in] buffer reference to setpoints buffer
+/// @return list of per degree-of-freedom joint setpoints, to be passed to RunControlStep
+DoFVariables** SetpointsBuffer_GetJointReadList( SetpointsBuffer buffer );
+
+/// @brief Gets reader side list of axis setpoints, valid until next update (reader thread only)
+/// @param[in] buffer reference to setpoints buffer
+/// @return list of per degree-of-freedom axis setpoints, to be passed to RunControlStep
+DoFVariables** SetpointsBuffer_GetAxisReadList( SetpointsBuffer buffer );
+
+#endif  // SETPOINTS_BUFFER_H
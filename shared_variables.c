@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "shared_variables.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SEGMENT_MAGIC 0x52435356U         // "RCSV"
+#define SEGMENT_VERSION 1
+
+// Segment layout: header on its own cache line, followed by joint measures, joint setpoints, axis measures and axis setpoints arrays
+typedef struct DOF_CACHE_LINE_ALIGNED SegmentHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t variableSize;
+  uint32_t jointsNumber;
+  uint32_t axesNumber;
+  atomic_uint_fast64_t sequence;          // Odd while a publication is in progress
+}
+SegmentHeader;
+
+struct _SharedVariablesData
+{
+  SegmentHeader* header;
+  size_t segmentSize;
+  DoFVariables* jointMeasures;
+  DoFVariables* jointSetpoints;
+  DoFVariables* axisMeasures;
+  DoFVariables* axisSetpoints;
+  char* name;                             // Only set for creator, which removes segment on close
+};
+
+
+static size_t GetSegmentSize( size_t jointsNumber, size_t axesNumber )
+{
+  return sizeof(SegmentHeader) + 2 * ( jointsNumber + axesNumber ) * sizeof(DoFVariables);
+}
+
+static SharedVariables MapSegment( int fd, size_t segmentSize, int protection )
+{
+  SharedVariables newVariables = (SharedVariables) calloc( 1, sizeof(SharedVariablesData) );
+  if( newVariables == NULL ) return NULL;
+  
+  void* segment = mmap( NULL, segmentSize, protection, MAP_SHARED, fd, 0 );
+  if( segment == MAP_FAILED )
+  {
+    free( newVariables );
+    return NULL;
+  }
+  
+  newVariables->header = (SegmentHeader*) segment;
+  newVariables->segmentSize = segmentSize;
+  
+  return newVariables;
+}
+
+static void SetArrays( SharedVariables variables, size_t jointsNumber, size_t axesNumber )
+{
+  variables->jointMeasures = (DoFVariables*) ( variables->header + 1 );
+  variables->jointSetpoints = variables->jointMeasures + jointsNumber;
+  variables->axisMeasures = variables->jointSetpoints + jointsNumber;
+  variables->axisSetpoints = variables->axisMeasures + axesNumber;
+}
+
+SharedVariables SharedVariables_Create( const char* name, size_t jointsNumber, size_t axesNumber )
+{
+  if( name == NULL || jointsNumber > UINT32_MAX || axesNumber > UINT32_MAX ) return NULL;
+  
+  // Existing segments are never replaced, as their readers would keep mapping the old one without noticing
+  int fd = shm_open( name, O_CREAT | O_EXCL | O_RDWR, 0644 );
+  if( fd == -1 ) return NULL;
+  
+  size_t segmentSize = GetSegmentSize( jointsNumber, axesNumber );
+  SharedVariables newVariables = NULL;
+  if( ftruncate( fd, (off_t) segmentSize ) == 0 ) newVariables = MapSegment( fd, segmentSize, PROT_READ | PROT_WRITE );
+  close( fd );
+  if( newVariables == NULL || ( newVariables->name = strdup( name ) ) == NULL )
+  {
+    SharedVariables_Close( newVariables );
+    shm_unlink( name );
+    return NULL;
+  }
+  
+  SegmentHeader* header = newVariables->header;
+  header->version = SEGMENT_VERSION;
+  header->variableSize = sizeof(DoFVariables);
+  header->jointsNumber = (uint32_t) jointsNumber;
+  header->axesNumber = (uint32_t) axesNumber;
+  atomic_init( &(header->sequence), 0 );
+  // Magic number written last marks the segment as ready for readers
+  atomic_thread_fence( memory_order_release );
+  header->magic = SEGMENT_MAGIC;
+  
+  SetArrays( newVariables, jointsNumber, axesNumber );
+  
+  return newVariables;
+}
+
+SharedVariables SharedVariables_Open( const char* name )
+{
+  if( name == NULL ) return NULL;
+  
+  int fd = shm_open( name, O_RDONLY, 0 );
+  if( fd == -1 ) return NULL;
+  
+  struct stat segmentStatus;
+  SharedVariables newVariables = NULL;
+  if( fstat( fd, &segmentStatus ) == 0 && (size_t) segmentStatus.st_size >= sizeof(SegmentHeader) ) 
+    newVariables = MapSegment( fd, (size_t) segmentStatus.st_size, PROT_READ );
+  close( fd );
+  if( newVariables == NULL ) return NULL;
+  
+  SegmentHeader* header = newVariables->header;
+  if( header->magic != SEGMENT_MAGIC || header->version != SEGMENT_VERSION || header->variableSize != sizeof(DoFVariables)
+      || newVariables->segmentSize < GetSegmentSize( header->jointsNumber, header->axesNumber ) )
+  {
+    SharedVariables_Close( newVariables );
+    return NULL;
+  }
+  atomic_thread_fence( memory_order_acquire );
+  
+  SetArrays( newVariables, header->jointsNumber, header->axesNumber );
+  
+  return newVariables;
+}
+
+void SharedVariables_Close( SharedVariables variables )
+{
+  if( variables == NULL ) return;
+  
+  munmap( variables->header, variables->segmentSize );
+  
+  if( variables->name != NULL )
+  {
+    shm_unlink( variables->name );
+    free( variables->name );
+  }
+  
+  free( variables );
+}
+
+static void CopyList( DoFVariables* array, DoFVariables** list, size_t dofsNumber )
+{
+  if( list == NULL ) return;
+  
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+    array[ dofIndex ] = *(list[ dofIndex ]);
+}
+
+void SharedVariables_Publish( SharedVariables variables, DoFVariables** jointMeasuresList, DoFVariables** jointSetpointsList, 
+                              DoFVariables** axisMeasuresList, DoFVariables** axisSetpointsList )
+{
+  SegmentHeader* header = variables->header;
+  
+  uint64_t sequence = atomic_load_explicit( &(header->sequence), memory_order_relaxed );
+  atomic_store_explicit( &(header->sequence), sequence + 1, memory_order_relaxed );
+  atomic_thread_fence( memory_order_release );
+  
+  CopyList( variables->jointMeasures, jointMeasuresList, header->jointsNumber );
+  CopyList( variables->jointSetpoints, jointSetpointsList, header->jointsNumber );
+  CopyList( variables->axisMeasures, axisMeasuresList, header->axesNumber );
+  CopyList( variables->axisSetpoints, axisSetpointsList, header->axesNumber );
+  
+  atomic_store_explicit( &(header->sequence), sequence + 2, memory_order_release );
+}
+
+uint64_t SharedVariables_BeginRead( SharedVariables variables )
+{
+  uint64_t sequence;
+  while( ( sequence = atomic_load_explicit( &(variables->header->sequence), memory_order_acquire ) ) & 1 ) sched_yield();
+  
+  return sequence;
+}
+
+bool SharedVariables_EndRead( SharedVariables variables, uint64_t sequence )
+{
+  atomic_thread_fence( memory_order_acquire );
+  
+  return ( atomic_load_explicit( &(variables->header->sequence), memory_order_relaxed ) == sequence );
+}
+
+size_t SharedVariables_GetJointsNumber( SharedVariables variables )
+{
+  return variables->header->jointsNumber;
+}
+
+size_t SharedVariables_GetAxesNumber( SharedVariables variables )
+{
+  return variables->header->axesNumber;
+}
+
+const DoFVariables* SharedVariables_GetJointMeasures( SharedVariables variables )
+{
+  return variables->jointMeasures;
+}
+
+const DoFVariables* SharedVariables_GetJointSetpoints( SharedVariables variables )
+{
+  return variables->jointSetpoints;
+}
+
+const DoFVariables* SharedVariables_GetAxisMeasures( SharedVariables variables )
+{
+  return variables->axisMeasures;
+}
+
+const DoFVariables* SharedVariables_GetAxisSetpoints( SharedVariables variables )
+{
+  return variables->axisSetpoints;
+}
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file shared_variables.h
+/// @brief Shared memory mirror of robot control step variables for other processes (GUI, logger, planner, etc.)
+///
+/// The control process publishes the 4 RunControlStep lists (joint/axis measures and setpoints) to a named POSIX shared memory segment,
+/// protected by a sequence lock: the writer never waits for readers, and readers access the segment data in place (without copies),
+/// validating afterwards that it wasn't modified meanwhile, in which case they just retry
+
+#ifndef SHARED_VARIABLES_H
+#define SHARED_VARIABLES_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Opaque shared variables data
+typedef struct _SharedVariablesData SharedVariablesData;
+/// Opaque reference to shared variables segment
+typedef SharedVariablesData* SharedVariables;
+
+/// @brief Creates shared memory segment for publishing variables of given numbers of degrees-of-freedom
+/// @param[in] name segment name (e.g. "/robot_variables"), not used by any existing segment (e.g. one left by a crashed process has to be removed with shm_unlink first)
+/// @param[in] jointsNumber number of joints (usually from plugin GetJointsNumber)
+/// @param[in] axesNumber number of axes (usually from plugin GetAxesNumber)
+/// @return reference to writable segment on success, NULL otherwise (e.g. segment name already in use)
+SharedVariables SharedVariables_Create( const char* name, size_t jointsNumber, size_t axesNumber );
+
+/// @brief Opens existing shared memory segment for reading
+/// @param[in] name segment name given on creation
+/// @return reference to read-only segment on success, NULL otherwise (e.g. nonexistent or incompatible segment)
+SharedVariables SharedVariables_Open( const char* name );
+
+/// @brief Unmaps shared memory segment (and removes its name, if created by this reference)
+/// @param[in] variables reference to shared variables segment
+void SharedVariables_Close( SharedVariables variables );
+
+/// @brief Copies control step lists to shared memory segment (single writer, usually right after RunControlStep), without blocking
+/// @param[in] variables reference to writable shared variables segment
+/// @param[in] jointMeasuresList list of per degree-of-freedom joint measures, or NULL to keep the last ones
+/// @param[in] jointSetpointsList list of per degree-of-freedom joint setpoints, or NULL to keep the last ones
+/// @param[in] axisMeasuresList list of per degree-of-freedom axis measures, or NULL to keep the last ones
+/// @param[in] axisSetpointsList list of per degree-of-freedom axis setpoints, or NULL to keep the last ones
+void SharedVariables_Publish( SharedVariables variables, DoFVariables** jointMeasuresList, DoFVariables** jointSetpointsList, 
+                              DoFVariables** axisMeasuresList, DoFVariables** axisSetpointsList );
+
+/// @brief Starts reading segment data in place, waiting for an ongoing publication to end
+/// @param[in] variables reference to shared variables segment
+/// @return sequence number to be checked with SharedVariables_EndRead
+uint64_t SharedVariables_BeginRead( SharedVariables variables );
+
+/// @brief Checks if data read since SharedVariables_BeginRead is a consistent snapshot, or has to be read again
+/// @param[in] variables reference to shared variables segment
+/// @param[in] sequence sequence number returned by SharedVariables_BeginRead
+/// @return true if no publication happened during reading, false otherwise
+bool SharedVariables_EndRead( SharedVariables variables, uint64_t sequence );
+
+/// @brief Gets number of joints of shared variables segment
+/// @param[in] variables reference to shared variables segment
+/// @return number of elements in joint lists
+size_t SharedVariables_GetJointsNumber( SharedVariables variables );
+
+/// @brief Gets number of axes of shared variables segment
+/// @param[in] variables reference to shared variables segment
+/// @return number of elements in axis lists
+size_t SharedVariables_GetAxesNumber( SharedVariables variables );
+
+/// @brief Gets array of joint measures inside shared memory segment (to be read between SharedVariables_BeginRead and SharedVariables_EndRead)
+/// @param[in] variables reference to shared variables segment
+/// @return array of per degree-of-freedom joint measures
+const DoFVariables* SharedVariables_GetJointMeasures( SharedVariables variables );
+
+/// @brief Gets array of joint setpoints inside shared memory segment (to be read between SharedVariables_BeginRead and SharedVariables_EndRead)
+/// @param[in] variables reference to shared variables segment
+/// @return array of per degree-of-freedom joint setpoints
+const DoFVariables* SharedVariables_GetJointSetpoints( SharedVariables variables );
+
+/// @brief Gets array of axis measures inside shared memory segment (to be read between SharedVariables_BeginRead and SharedVariables_EndRead)
+/// @param[in] variables reference to shared variables segment
+/// @return array of per degree-of-freedom axis measures
+const DoFVariables* SharedVariables_GetAxisMeasures( SharedVariables variables );
+
+/// @brief Gets array of axis setpoints inside shared memory segment (to be read between SharedVariables_BeginRead and SharedVariables_EndRead)
+/// @param[in] variables reference to shared variables segment
+/// @return array of per degree-of-freedom axis setpoints
+const DoFVariables* SharedVariables_GetAxisSetpoints( SharedVariables variables );
+
+#endif  // SHARED_VARIABLES_H
@@ -0,0 +1,274 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "telemetry_ring.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Record slot layout: sequence number, followed by payload of time delta, joint measures, joint setpoints, axis measures, 
+// axis setpoints and extra outputs, padded to a multiple of the cache line size
+typedef struct RecordHeader
+{
+  atomic_uint_fast64_t sequence;          // 2 * index + 1 while record of given index is written, 2 * index + 2 when complete
+  double timeDelta;
+}
+RecordHeader;
+
+struct _TelemetryRingData
+{
+  atomic_uint_fast64_t recordsCount;      // Only written by producer, on its own cache line
+  char padding[ DOF_CACHE_LINE_SIZE - sizeof(atomic_uint_fast64_t) ];
+  uint8_t* slots;
+  size_t slotSize;
+  uint64_t slotsMask;
+  size_t jointsNumber, axesNumber, extraOutputsNumber;
+  size_t payloadSize;                     // Size of record data after sequence number
+};
+
+struct _TelemetryCursorData
+{
+  TelemetryRing ring;
+  uint64_t nextIndex;
+  uint64_t recordIndex;
+  uint64_t lostRecordsCount;
+  double* payload;                        // Copy of last read record, with the same layout as ring slots after sequence number
+  double* scratchPayload;                 // Copy of record being read, only moved to payload if not overwritten meanwhile
+  DoFVariables* jointMeasures;
+  DoFVariables* jointSetpoints;
+  DoFVariables* axisMeasures;
+  DoFVariables* axisSetpoints;
+  double* extraOutputs;
+};
+
+
+static inline RecordHeader* GetSlot( TelemetryRing ring, uint64_t index )
+{
+  return (RecordHeader*) ( ring->slots + ( index & ring->slotsMask ) * ring->slotSize );
+}
+
+TelemetryRing TelemetryRing_Create( size_t jointsNumber, size_t axesNumber, size_t extraOutputsNumber, size_t recordsNumber )
+{
+  if( recordsNumber == 0 || recordsNumber > SIZE_MAX / 2 ) return NULL;
+  
+  TelemetryRing newRing = (TelemetryRing) aligned_alloc( DOF_CACHE_LINE_SIZE, sizeof(TelemetryRingData) );
+  if( newRing == NULL ) return NULL;
+  memset( newRing, 0, sizeof(TelemetryRingData) );
+  
+  size_t slotsNumber = 1;
+  while( slotsNumber < recordsNumber ) slotsNumber *= 2;
+  
+  newRing->jointsNumber = jointsNumber;
+  newRing->axesNumber = axesNumber;
+  newRing->extraOutputsNumber = extraOutputsNumber;
+  newRing->payloadSize = sizeof(double) + 2 * ( jointsNumber + axesNumber ) * sizeof(DoFVariables) + extraOutputsNumber * sizeof(double);
+  // Slots aligned to cache lines, so that the producer writing one record doesn't invalidate lines of records being read
+  newRing->slotSize = offsetof( RecordHeader, timeDelta ) + newRing->payloadSize;
+  newRing->slotSize = ( newRing->slotSize + DOF_CACHE_LINE_SIZE - 1 ) / DOF_CACHE_LINE_SIZE * DOF_CACHE_LINE_SIZE;
+  newRing->slotsMask = slotsNumber - 1;
+  
+  if( slotsNumber > SIZE_MAX / newRing->slotSize 
+      || ( newRing->slots = (uint8_t*) aligned_alloc( DOF_CACHE_LINE_SIZE, slotsNumber * newRing->slotSize ) ) == NULL )
+  {
+    free( newRing );
+    return NULL;
+  }
+  memset( newRing->slots, 0, slotsNumber * newRing->slotSize );
+  
+  for( uint64_t slotIndex = 0; slotIndex < slotsNumber; slotIndex++ )
+    atomic_init( &(GetSlot( newRing, slotIndex )->sequence), 0 );
+  atomic_init( &(newRing->recordsCount), 0 );
+  
+  return newRing;
+}
+
+void TelemetryRing_Discard( TelemetryRing ring )
+{
+  if( ring == NULL ) return;
+  
+  free( ring->slots );
+  free( ring );
+}
+
+static inline DoFVariables* CopyList( DoFVariables* array, DoFVariables** list, size_t dofsNumber )
+{
+  if( list == NULL ) return array + dofsNumber;
+  
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+    array[ dofIndex ] = *(list[ dofIndex ]);
+  
+  return array + dofsNumber;
+}
+
+void TelemetryRing_Publish( TelemetryRing ring, DoFVariables** jointMeasuresList, DoFVariables** jointSetpointsList, 
+                            DoFVariables** axisMeasuresList, DoFVariables** axisSetpointsList, double* extraOutputsList, double timeDelta )
+{
+  uint64_t index = atomic_load_explicit( &(ring->recordsCount), memory_order_relaxed );
+  RecordHeader* slot = GetSlot( ring, index );
+  
+  // Mark slot as being written before overwriting the record it held, so that readers copying it meanwhile discard their copy
+  atomic_store_explicit( &(slot->sequence), 2 * index + 1, memory_order_relaxed );
+  atomic_thread_fence( memory_order_release );
+  
+  slot->timeDelta = timeDelta;
+  DoFVariables* array = (DoFVariables*) ( &(slot->timeDelta) + 1 );
+  array = CopyList( array, jointMeasuresList, ring->jointsNumber );
+  array = CopyList( array, jointSetpointsList, ring->jointsNumber );
+  array = CopyList( array, axisMeasuresList, ring->axesNumber );
+  array = CopyList( array, axisSetpointsList, ring->axesNumber );
+  if( extraOutputsList != NULL ) memcpy( array, extraOutputsList, ring->extraOutputsNumber * sizeof(double) );
+  
+  atomic_store_explicit( &(slot->sequence), 2 * index + 2, memory_order_release );
+  atomic_store_explicit( &(ring->recordsCount), index + 1, memory_order_release );
+}
+
+uint64_t TelemetryRing_GetRecordsCount( TelemetryRing ring )
+{
+  return atomic_load_explicit( &(ring->recordsCount), memory_order_acquire );
+}
+
+TelemetryCursor TelemetryCursor_Create( TelemetryRing ring )
+{
+  if( ring == NULL ) return NULL;
+  
+  TelemetryCursor newCursor = (TelemetryCursor) calloc( 1, sizeof(TelemetryCursorData) );
+  if( newCursor == NULL ) return NULL;
+  
+  newCursor->payload = (double*) calloc( 1, ring->payloadSize );
+  newCursor->scratchPayload = (double*) calloc( 1, ring->payloadSize );
+  if( newCursor->payload == NULL || newCursor->scratchPayload == NULL )
+  {
+    free( newCursor->payload );
+    free( newCursor->scratchPayload );
+    free( newCursor );
+    return NULL;
+  }
+  
+  newCursor->ring = ring;
+  newCursor->nextIndex = TelemetryRing_GetRecordsCount( ring );
+  newCursor->recordIndex = newCursor->nextIndex - 1;
+  
+  newCursor->jointMeasures = (DoFVariables*) ( newCursor->payload + 1 );
+  newCursor->jointSetpoints = newCursor->jointMeasures + ring->jointsNumber;
+  newCursor->axisMeasures = newCursor->jointSetpoints + ring->jointsNumber;
+  newCursor->axisSetpoints = newCursor->axisMeasures + ring->axesNumber;
+  newCursor->extraOutputs = (double*) ( newCursor->axisSetpoints + ring->axesNumber );
+  
+  return newCursor;
+}
+
+void TelemetryCursor_Discard( TelemetryCursor cursor )
+{
+  if( cursor == NULL ) return;
+  
+  free( cursor->payload );
+  free( cursor->scratchPayload );
+  free( cursor );
+}
+
+bool TelemetryCursor_Read( TelemetryCursor cursor, size_t* lostRecordsNumber )
+{
+  TelemetryRing ring = cursor->ring;
+  uint64_t slotsNumber = ring->slotsMask + 1;
+  uint64_t lostRecordsCount = 0;
+  bool recordRead = false;
+  
+  while( !recordRead )
+  {
+    uint64_t recordsCount = atomic_load_explicit( &(ring->recordsCount), memory_order_acquire );
+    if( cursor->nextIndex >= recordsCount ) break;
+    
+    // Records older than the ring size were already overwritten
+    if( recordsCount - cursor->nextIndex > slotsNumber )
+    {
+      lostRecordsCount += recordsCount - slotsNumber - cursor->nextIndex;
+      cursor->nextIndex = recordsCount - slotsNumber;
+    }
+    
+    RecordHeader* slot = GetSlot( ring, cursor->nextIndex );
+    uint64_t sequence = atomic_load_explicit( &(slot->sequence), memory_order_acquire );
+    if( sequence == 2 * cursor->nextIndex + 2 )
+    {
+      memcpy( cursor->scratchPayload, &(slot->timeDelta), ring->payloadSize );
+      // Copy is only valid if the producer didn't start overwriting the slot meanwhile, otherwise the last read record is kept
+      atomic_thread_fence( memory_order_acquire );
+      recordRead = ( atomic_load_explicit( &(slot->sequence), memory_order_relaxed ) == sequence );
+      if( recordRead ) memcpy( cursor->payload, cursor->scratchPayload, ring->payloadSize );
+    }
+    
+    if( recordRead ) cursor->recordIndex = cursor->nextIndex;
+    else lostRecordsCount++;
+    cursor->nextIndex++;
+  }
+  
+  cursor->lostRecordsCount += lostRecordsCount;
+  if( lostRecordsNumber != NULL ) *lostRecordsNumber = (size_t) lostRecordsCount;
+  
+  return recordRead;
+}
+
+uint64_t TelemetryCursor_GetLostRecordsCount( TelemetryCursor cursor )
+{
+  return cursor->lostRecordsCount;
+}
+
+uint64_t TelemetryCursor_GetPendingRecordsCount( TelemetryCursor cursor )
+{
+  uint64_t recordsCount = TelemetryRing_GetRecordsCount( cursor->ring );
+  
+  return ( recordsCount > cursor->nextIndex ) ? recordsCount - cursor->nextIndex : 0;
+}
+
+uint64_t TelemetryCursor_GetRecordIndex( TelemetryCursor cursor )
+{
+  return cursor->recordIndex;
+}
+
+double TelemetryCursor_GetTimeDelta( TelemetryCursor cursor )
+{
+  return cursor->payload[ 0 ];
+}
+
+const DoFVariables* TelemetryCursor_GetJointMeasures( TelemetryCursor cursor )
+{
+  return cursor->jointMeasures;
+}
+
+const DoFVariables* TelemetryCursor_GetJointSetpoints( TelemetryCursor cursor )
+{
+  return cursor->jointSetpoints;
+}
+
+const DoFVariables* TelemetryCursor_GetAxisMeasures( TelemetryCursor cursor )
+{
+  return cursor->axisMeasures;
+}
+
+const DoFVariables* TelemetryCursor_GetAxisSetpoints( TelemetryCursor cursor )
+{
+  return cursor->axisSetpoints;
+}
+
+const double* TelemetryCursor_GetExtraOutputs( TelemetryCursor cursor )
+{
+  return cursor->extraOutputs;
+}
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file telemetry_ring.h
+/// @brief Single producer, multiple consumer overwrite ring of per control step telemetry records
+///
+/// The control thread copies each step's joint/axis measures and setpoints and extra outputs to the next ring slot, never waiting 
+/// for consumers (loggers, visualizers, monitors) and overwriting the oldest record when the ring is full. Each consumer reads through 
+/// its own cursor, copying records out and validating them with a per slot sequence number, so that records overwritten before or while 
+/// being read are skipped and counted as lost, instead of slowing down the producer
+
+#ifndef TELEMETRY_RING_H
+#define TELEMETRY_RING_H
+
+#include "robot_control.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Opaque telemetry ring data
+typedef struct _TelemetryRingData TelemetryRingData;
+/// Opaque reference to telemetry ring
+typedef TelemetryRingData* TelemetryRing;
+
+/// Opaque telemetry cursor data
+typedef struct _TelemetryCursorData TelemetryCursorData;
+/// Opaque reference to consumer cursor of telemetry ring
+typedef TelemetryCursorData* TelemetryCursor;
+
+/// @brief Creates telemetry ring for records of given numbers of degrees-of-freedom and extra outputs
+/// @param[in] jointsNumber number of joints (usually from plugin GetJointsNumber)
+/// @param[in] axesNumber number of axes (usually from plugin GetAxesNumber)
+/// @param[in] extraOutputsNumber number of extra outputs (usually from plugin GetExtraOutputsNumber)
+/// @param[in] recordsNumber minimum number of records kept in the ring (rounded up to a power of 2)
+/// @return reference to created ring on success, NULL otherwise
+TelemetryRing TelemetryRing_Create( size_t jointsNumber, size_t axesNumber, size_t extraOutputsNumber, size_t recordsNumber );
+
+/// @brief Deallocates data of given telemetry ring (after discarding all of its cursors)
+/// @param[in] ring reference to telemetry ring
+void TelemetryRing_Discard( TelemetryRing ring );
+
+/// @brief Copies control step variables to a new ring record (producer thread only, wait-free, usually right after RunControlStep)
+/// @param[in] ring reference to telemetry ring
+/// @param[in] jointMeasuresList list of per degree-of-freedom joint measures
+/// @param[in] jointSetpointsList list of per degree-of-freedom joint setpoints
+/// @param[in] axisMeasuresList list of per degree-of-freedom axis measures
+/// @param[in] axisSetpointsList list of per degree-of-freedom axis setpoints
+/// @param[in] extraOutputsList list of extra output values (may be NULL if there are no extra outputs)
+/// @param[in] timeDelta time interval of the recorded control step (in seconds)
+void TelemetryRing_Publish( TelemetryRing ring, DoFVariables** jointMeasuresList, DoFVariables** jointSetpointsList, 
+                            DoFVariables** axisMeasuresList, DoFVariables** axisSetpointsList, double* extraOutputsList, double timeDelta );
+
+/// @brief Gets number of records published to telemetry ring so far (any thread)
+/// @param[in] ring reference to telemetry ring
+/// @return number of published records (index of the next one)
+uint64_t TelemetryRing_GetRecordsCount( TelemetryRing ring );
+
+/// @brief Creates consumer cursor of telemetry ring, positioned after the last published record
+/// @param[in] ring reference to telemetry ring
+/// @return reference to created cursor on success, NULL otherwise
+TelemetryCursor TelemetryCursor_Create( TelemetryRing ring );
+
+/// @brief Deallocates data of given consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+void TelemetryCursor_Discard( TelemetryCursor cursor );
+
+/// @brief Copies next unread record of the ring to cursor (consumer thread only, lock-free), skipping overwritten ones
+/// @param[in] cursor reference to telemetry cursor
+/// @param[out] lostRecordsNumber number of records overwritten since the previous read and skipped (may be NULL)
+/// @return true if a record was read, false if there are no new records (keeping the previous one)
+bool TelemetryCursor_Read( TelemetryCursor cursor, size_t* lostRecordsNumber );
+
+/// @brief Gets total number of records skipped by consumer cursor for being overwritten before read (overruns)
+/// @param[in] cursor reference to telemetry cursor
+/// @return number of lost records
+uint64_t TelemetryCursor_GetLostRecordsCount( TelemetryCursor cursor );
+
+/// @brief Gets number of published records not yet read by consumer cursor (may be larger than the ring size if overrun)
+/// @param[in] cursor reference to telemetry cursor
+/// @return number of pending records
+uint64_t TelemetryCursor_GetPendingRecordsCount( TelemetryCursor cursor );
+
+/// @brief Gets index (in publication order, starting from 0) of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return record index
+uint64_t TelemetryCursor_GetRecordIndex( TelemetryCursor cursor );
+
+/// @brief Gets control step time interval of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return recorded time delta (in seconds)
+double TelemetryCursor_GetTimeDelta( TelemetryCursor cursor );
+
+/// @brief Gets array of joint measures of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return array of per degree-of-freedom joint measures, valid until next read
+const DoFVariables* TelemetryCursor_GetJointMeasures( TelemetryCursor cursor );
+
+/// @brief Gets array of joint setpoints of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return array of per degree-of-freedom joint setpoints, valid until next read
+const DoFVariables* TelemetryCursor_GetJointSetpoints( TelemetryCursor cursor );
+
+/// @brief Gets array of axis measures of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return array of per degree-of-freedom axis measures, valid until next read
+const DoFVariables* TelemetryCursor_GetAxisMeasures( TelemetryCursor cursor );
+
+/// @brief Gets array of axis setpoints of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return array of per degree-of-freedom axis setpoints, valid until next read
+const DoFVariables* TelemetryCursor_GetAxisSetpoints( TelemetryCursor cursor );
+
+/// @brief Gets array of extra outputs of the last record read by consumer cursor
+/// @param[in] cursor reference to telemetry cursor
+/// @return array of extra output values, valid until next read
+const double* TelemetryCursor_GetExtraOutputs( TelemetryCursor cursor );
+
+#endif  // TELEMETRY_RING_H
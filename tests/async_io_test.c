@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "async_io.h"
+#include "test_check.h"
+
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEVICES_NUMBER 2
+#define BUFFER_SIZE 256
+#define MAX_PROCESS_CALLS 1000
+
+static size_t ReadPeer( int fd, char* data, size_t maxDataSize )
+{
+  struct pollfd peer = { .fd = fd, .events = POLLIN };
+  if( poll( &peer, 1, 1000 ) != 1 ) return 0;
+  
+  ssize_t dataSize = read( fd, data, maxDataSize );
+  return ( dataSize > 0 ) ? (size_t) dataSize : 0;
+}
+
+// Processes until given number of bytes is received from device, as completions may take a few calls
+static size_t ReadDevice( AsyncIO io, int deviceIndex, char* data, size_t dataSize )
+{
+  size_t receivedSize = 0;
+  for( size_t callIndex = 0; callIndex < MAX_PROCESS_CALLS && receivedSize < dataSize; callIndex++ )
+  {
+    AsyncIO_Process( io );
+    receivedSize += AsyncIO_Read( io, deviceIndex, data + receivedSize, dataSize - receivedSize );
+    struct timespec waitTime = { .tv_sec = 0, .tv_nsec = 100000 };
+    nanosleep( &waitTime, NULL );
+  }
+  
+  return receivedSize;
+}
+
+static void TestBackend( enum AsyncIOBackend backend )
+{
+  int socketsList[ DEVICES_NUMBER ][ 2 ];
+  int devicesList[ DEVICES_NUMBER ];
+  
+  AsyncIO io = AsyncIO_Create( DEVICES_NUMBER, backend );
+  TEST_CHECK( io != NULL );
+  if( backend == ASYNC_IO_POLL ) TEST_CHECK( !AsyncIO_IsUsingIOUring( io ) );
+  else if( !AsyncIO_IsUsingIOUring( io ) ) fprintf( stderr, "io_uring not supported by running kernel: testing poll fallback\n" );
+  
+  for( size_t deviceIndex = 0; deviceIndex < DEVICES_NUMBER; deviceIndex++ )
+  {
+    TEST_CHECK( socketpair( AF_UNIX, SOCK_STREAM, 0, socketsList[ deviceIndex ] ) == 0 );
+    devicesList[ deviceIndex ] = AsyncIO_AddDevice( io, socketsList[ deviceIndex ][ 0 ], BUFFER_SIZE );
+    TEST_CHECK( devicesList[ deviceIndex ] >= 0 );
+  }
+  TEST_CHECK( AsyncIO_AddDevice( io, socketsList[ 0 ][ 0 ], BUFFER_SIZE ) == -1 );
+  
+  TEST_CHECK( AsyncIO_Write( io, devicesList[ 0 ], "request 0", 9 ) );
+  TEST_CHECK( AsyncIO_Write( io, devicesList[ 1 ], "request 1", 9 ) );
+  TEST_CHECK( !AsyncIO_Write( io, devicesList[ 1 ], NULL, BUFFER_SIZE + 1 ) );
+  TEST_CHECK( !AsyncIO_Write( io, DEVICES_NUMBER, "request", 7 ) );
+  AsyncIO_Process( io );
+  
+  char data[ BUFFER_SIZE ] = { 0 };
+  for( size_t deviceIndex = 0; deviceIndex < DEVICES_NUMBER; deviceIndex++ )
+  {
+    char request[ 16 ];
+    snprintf( request, sizeof(request), "request %zu", deviceIndex );
+    TEST_CHECK( ReadPeer( socketsList[ deviceIndex ][ 1 ], data, sizeof(data) ) == 9 && memcmp( data, request, 9 ) == 0 );
+  }
+  
+  // Replies from both devices are collected by the same processing calls, in order
+  TEST_CHECK( write( socketsList[ 1 ][ 1 ], "reply 1", 7 ) == 7 );
+  TEST_CHECK( write( socketsList[ 0 ][ 1 ], "reply 0", 7 ) == 7 );
+  TEST_CHECK( write( socketsList[ 0 ][ 1 ], " more", 5 ) == 5 );
+  TEST_CHECK( ReadDevice( io, devicesList[ 0 ], data, 12 ) == 12 && memcmp( data, "reply 0 more", 12 ) == 0 );
+  TEST_CHECK( ReadDevice( io, devicesList[ 1 ], data, 7 ) == 7 && memcmp( data, "reply 1", 7 ) == 0 );
+  TEST_CHECK( AsyncIO_Read( io, devicesList[ 1 ], data, sizeof(data) ) == 0 );
+  
+  AsyncIO_Discard( io );
+  
+  for( size_t deviceIndex = 0; deviceIndex < DEVICES_NUMBER; deviceIndex++ )
+  {
+    close( socketsList[ deviceIndex ][ 0 ] );
+    close( socketsList[ deviceIndex ][ 1 ] );
+  }
+}
+
+int main( void )
+{
+  TestBackend( ASYNC_IO_AUTO );
+  TestBackend( ASYNC_IO_POLL );
+  
+  return EXIT_SUCCESS;
+}
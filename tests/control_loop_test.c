@@ -0,0 +1,282 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "control_loop.h"
+#include "test_check.h"
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PIPELINED_RESTARTS_NUMBER 200
+#define OVERRUN_STEPS_NUMBER 40
+#define OVERRUN_STEP_PERIOD 0.01
+#define OVERRUN_STEP_DURATION 0.025
+#define MAX_DEADLINE_MISSES 3
+#define SECOND_OVERRUN_STEP 25
+
+// Damped oscillator integrated on each step, so that any difference of time deltas or step ordering changes its final state
+typedef struct PlantData
+{
+  double position, velocity;
+  uint64_t stepsCount, slowStepsCount;
+  double slowTimeDeltasSum, lastSlowTimeDelta;
+  double minTimeDelta, maxTimeDelta;
+}
+PlantData;
+
+static void RunPlantStep( void* stepData, double timeDelta )
+{
+  PlantData* plant = (PlantData*) stepData;
+  double acceleration = -40.0 * plant->position - 0.5 * plant->velocity;
+  plant->position += plant->velocity * timeDelta;
+  plant->velocity += acceleration * timeDelta;
+  plant->stepsCount++;
+  if( timeDelta < plant->minTimeDelta ) plant->minTimeDelta = timeDelta;
+  if( timeDelta > plant->maxTimeDelta ) plant->maxTimeDelta = timeDelta;
+}
+
+static void RunPlantSlowStep( void* stepData, double timeDelta )
+{
+  PlantData* plant = (PlantData*) stepData;
+  plant->velocity *= 0.999;
+  plant->slowStepsCount++;
+  plant->slowTimeDeltasSum += timeDelta;
+  plant->lastSlowTimeDelta = timeDelta;
+}
+
+static PlantData RunVirtualPlant( const ControlLoopSettings* settings, const double* timeDeltasList, size_t timeDeltasNumber, uint64_t stepsNumber )
+{
+  PlantData plant = { .position = 1.0, .minTimeDelta = 1.0e9 };
+  TEST_CHECK( ControlLoop_RunVirtual( settings, timeDeltasList, timeDeltasNumber, stepsNumber, RunPlantStep, RunPlantSlowStep, &plant ) == stepsNumber );
+  
+  return plant;
+}
+
+static void TestVirtualDeterminism( void )
+{
+  const double TIME_DELTAS_LIST[] = { 0.001, 0.0011, 0.0009, 0.00105, 0.00095 };
+  const size_t TIME_DELTAS_NUMBER = sizeof(TIME_DELTAS_LIST) / sizeof(double);
+  ControlLoopSettings settings = { .stepPeriod = 0.001, .slowStepPeriod = 0.004 };
+  
+  // Scripted time deltas: same results on every run, with slow steps getting the sum of their 4 step deltas
+  PlantData firstPlant = RunVirtualPlant( &settings, TIME_DELTAS_LIST, TIME_DELTAS_NUMBER, 10000 );
+  PlantData secondPlant = RunVirtualPlant( &settings, TIME_DELTAS_LIST, TIME_DELTAS_NUMBER, 10000 );
+  TEST_CHECK( memcmp( &firstPlant, &secondPlant, sizeof(PlantData) ) == 0 );
+  TEST_CHECK( firstPlant.stepsCount == 10000 && firstPlant.slowStepsCount == 2500 );
+  TEST_CHECK( firstPlant.minTimeDelta == 0.0009 && firstPlant.maxTimeDelta == 0.0011 );
+  // 10000 steps are 2000 whole script cycles
+  double timeDeltasSum = 0.0;
+  for( size_t timeDeltaIndex = 0; timeDeltaIndex < TIME_DELTAS_NUMBER; timeDeltaIndex++ )
+    timeDeltasSum += TIME_DELTAS_LIST[ timeDeltaIndex ];
+  TEST_CHECK( fabs( firstPlant.slowTimeDeltasSum - 2000 * timeDeltasSum ) < 1.0e-9 );
+  
+  // Fixed period
+  PlantData fixedPlant = RunVirtualPlant( &settings, NULL, 0, 1000 );
+  TEST_CHECK( fixedPlant.minTimeDelta == 0.001 && fixedPlant.maxTimeDelta == 0.001 );
+  TEST_CHECK( fixedPlant.slowStepsCount == 250 && fabs( fixedPlant.lastSlowTimeDelta - 0.004 ) < 1.0e-12 );
+  TEST_CHECK( memcmp( &fixedPlant, &firstPlant, sizeof(PlantData) ) != 0 );
+}
+
+static void TestVirtualInvalidSettings( void )
+{
+  PlantData plant = { 0 };
+  ControlLoopSettings settings = { .stepPeriod = 0.0 };
+  const double TIME_DELTAS_LIST[] = { 0.001 };
+  
+  TEST_CHECK( ControlLoop_RunVirtual( NULL, NULL, 0, 10, RunPlantStep, NULL, &plant ) == 0 );
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, NULL, 0, 10, RunPlantStep, NULL, &plant ) == 0 );
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 0, 10, RunPlantStep, NULL, &plant ) == 0 );
+  // Slow step divider is computed from periods also when time deltas come from the list
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 1, 10, RunPlantStep, RunPlantSlowStep, &plant ) == 0 );
+  settings.stepPeriod = -0.001;
+  settings.slowStepPeriod = -0.004;
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 1, 10, RunPlantStep, RunPlantSlowStep, &plant ) == 0 );
+  settings.stepPeriod = 0.001;
+  settings.slowStepPeriod = INFINITY;
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 1, 10, RunPlantStep, RunPlantSlowStep, &plant ) == 0 );
+  settings.slowStepPeriod = NAN;
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 1, 10, RunPlantStep, RunPlantSlowStep, &plant ) == 0 );
+  TEST_CHECK( ControlLoop_StartMultiRate( &settings, RunPlantStep, RunPlantSlowStep, &plant ) == NULL );
+  settings.slowStepPeriod = 0.0005;
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 1, 10, RunPlantStep, RunPlantSlowStep, &plant ) == 0 );
+  // Without slow step, its period is not used
+  TEST_CHECK( ControlLoop_RunVirtual( &settings, TIME_DELTAS_LIST, 1, 10, RunPlantStep, NULL, &plant ) == 10 );
+  TEST_CHECK( plant.stepsCount == 10 && plant.slowStepsCount == 0 );
+}
+
+static void TestRealTimeLoop( void )
+{
+  PlantData plant = { .position = 1.0, .minTimeDelta = 1.0e9 };
+  ControlLoopSettings settings = { .stepPeriod = 0.001 };
+  
+  ControlLoop loop = ControlLoop_Start( &settings, RunPlantStep, &plant );
+  TEST_CHECK( loop != NULL );
+  struct timespec runTime = { .tv_sec = 0, .tv_nsec = 100000000 };
+  nanosleep( &runTime, NULL );
+  ControlLoopStatus status;
+  ControlLoop_GetStatus( loop, &status );
+  ControlLoop_Stop( loop );
+  
+  // Loose bounds, as test machines may be loaded
+  TEST_CHECK( status.stepsCount > 10 && status.stepsCount <= 110 );
+  TEST_CHECK( plant.stepsCount >= status.stepsCount && plant.minTimeDelta > 0.0 );
+  TEST_CHECK( status.lastTimeDelta > 0.0 );
+}
+
+// Zero-initialized placement doesn't restrict loop threads, while invalid placements fail loop start
+static void TestLoopPlacement( void )
+{
+  PlantData plant = { .position = 1.0, .minTimeDelta = 1.0e9 };
+  ControlPlacement placement = { 0 };
+  ControlLoopSettings settings = { .stepPeriod = 0.001, .placement = &placement };
+  
+  ControlLoop loop = ControlLoop_Start( &settings, RunPlantStep, &plant );
+  TEST_CHECK( loop != NULL );
+  ControlLoop_Stop( loop );
+  
+  placement.isMemoryBound = true;
+  placement.memoryNode = -1;
+  TEST_CHECK( ControlLoop_Start( &settings, RunPlantStep, &plant ) == NULL );
+}
+
+// Steps overrunning the period in 2 bursts: a first one longer than the allowed consecutive deadline misses, and a shorter one after steps meet deadlines again
+typedef struct OverrunData
+{
+  atomic_uint_fast64_t stepsCount;
+  uint64_t passiveStatesCountsList[ OVERRUN_STEPS_NUMBER ];
+}
+OverrunData;
+
+static atomic_uint_fast64_t passiveStatesCount;
+static atomic_int lastControlState;
+
+static void SetOverrunControlState( enum ControlState controlState )
+{
+  atomic_store( &(lastControlState), (int) controlState );
+  if( controlState == CONTROL_PASSIVE ) atomic_fetch_add( &passiveStatesCount, 1 );
+}
+
+static void RunOverrunStep( void* stepData, double timeDelta )
+{
+  OverrunData* overrun = (OverrunData*) stepData;
+  (void) timeDelta;
+  uint64_t stepIndex = atomic_load( &(overrun->stepsCount) );
+  if( stepIndex < OVERRUN_STEPS_NUMBER ) overrun->passiveStatesCountsList[ stepIndex ] = atomic_load( &passiveStatesCount );
+  if( stepIndex < MAX_DEADLINE_MISSES + 2 || ( stepIndex >= SECOND_OVERRUN_STEP && stepIndex < SECOND_OVERRUN_STEP + MAX_DEADLINE_MISSES - 1 ) )
+  {
+    struct timespec stepTime = { .tv_sec = 0, .tv_nsec = (long) ( OVERRUN_STEP_DURATION * 1e9 ) };
+    nanosleep( &stepTime, NULL );
+  }
+  atomic_fetch_add( &(overrun->stepsCount), 1 );
+}
+
+static void TestDeadlineMisses( void )
+{
+  OverrunData overrun = { .stepsCount = 0 };
+  ControlLoopSettings settings = { .stepPeriod = OVERRUN_STEP_PERIOD, .maxDeadlineMisses = MAX_DEADLINE_MISSES, 
+                                   .setControlState = SetOverrunControlState };
+  atomic_init( &passiveStatesCount, 0 );
+  atomic_init( &lastControlState, -1 );
+  
+  ControlLoop loop = ControlLoop_Start( &settings, RunOverrunStep, &overrun );
+  TEST_CHECK( loop != NULL );
+  struct timespec waitTime = { .tv_sec = 0, .tv_nsec = 10000000 };
+  while( atomic_load( &(overrun.stepsCount) ) < OVERRUN_STEPS_NUMBER )
+    nanosleep( &waitTime, NULL );
+  ControlLoopStatus status;
+  ControlLoop_GetStatus( loop, &status );
+  ControlLoop_Stop( loop );
+  
+  // Degraded once, right after the step completing the allowed consecutive misses
+  TEST_CHECK( overrun.passiveStatesCountsList[ MAX_DEADLINE_MISSES - 1 ] == 0 );
+  TEST_CHECK( overrun.passiveStatesCountsList[ MAX_DEADLINE_MISSES ] == 1 );
+  TEST_CHECK( atomic_load( &passiveStatesCount ) == 1 && atomic_load( &lastControlState ) == CONTROL_PASSIVE );
+  TEST_CHECK( status.degradationsCount == 1 );
+  // All overrunning steps are counted, but steps meeting deadlines reset consecutive misses (machine stalls may add a few misses)
+  TEST_CHECK( status.deadlineMissesCount >= MAX_DEADLINE_MISSES + 2 + MAX_DEADLINE_MISSES - 1 );
+  TEST_CHECK( status.consecutiveDeadlineMisses < MAX_DEADLINE_MISSES );
+}
+
+// Compute phase checks that it never uses the buffer of an I/O phase in progress
+typedef struct PipelineData
+{
+  atomic_int ioBufferIndex;
+  atomic_uint_fast64_t ioPhasesCount, computePhasesCount, overlapsCount;
+}
+PipelineData;
+
+static void RunIOPhase( void* stepData, size_t bufferIndex, double timeDelta )
+{
+  PipelineData* pipeline = (PipelineData*) stepData;
+  (void) timeDelta;
+  atomic_store( &(pipeline->ioBufferIndex), (int) bufferIndex );
+  atomic_fetch_add( &(pipeline->ioPhasesCount), 1 );
+  atomic_store( &(pipeline->ioBufferIndex), -1 );
+}
+
+static void RunComputePhase( void* stepData, size_t bufferIndex, double timeDelta )
+{
+  PipelineData* pipeline = (PipelineData*) stepData;
+  (void) timeDelta;
+  if( atomic_load( &(pipeline->ioBufferIndex) ) == (int) bufferIndex ) atomic_fetch_add( &(pipeline->overlapsCount), 1 );
+  atomic_fetch_add( &(pipeline->computePhasesCount), 1 );
+}
+
+static void TestPipelinedStartStop( void )
+{
+  PipelineData pipeline;
+  ControlLoopSettings settings = { .stepPeriod = 0.0001 };
+  
+  // Stops at varying points of the cycle, with a watchdog ending the test if any stop deadlocks
+  alarm( 60 );
+  for( size_t restartIndex = 0; restartIndex < PIPELINED_RESTARTS_NUMBER; restartIndex++ )
+  {
+    atomic_init( &(pipeline.ioBufferIndex), -1 );
+    atomic_init( &(pipeline.ioPhasesCount), 0 );
+    atomic_init( &(pipeline.computePhasesCount), 0 );
+    atomic_init( &(pipeline.overlapsCount), 0 );
+    
+    ControlLoop loop = ControlLoop_StartPipelined( &settings, RunIOPhase, RunComputePhase, &pipeline );
+    TEST_CHECK( loop != NULL );
+    struct timespec runTime = { .tv_sec = 0, .tv_nsec = (long) ( restartIndex % 20 ) * 37000 };
+    nanosleep( &runTime, NULL );
+    ControlLoop_Stop( loop );
+    
+    TEST_CHECK( atomic_load( &(pipeline.ioPhasesCount) ) == atomic_load( &(pipeline.computePhasesCount) ) );
+    TEST_CHECK( atomic_load( &(pipeline.overlapsCount) ) == 0 );
+  }
+  alarm( 0 );
+}
+
+int main( void )
+{
+  TestVirtualDeterminism();
+  TestVirtualInvalidSettings();
+  TestRealTimeLoop();
+  TestLoopPlacement();
+  TestDeadlineMisses();
+  TestPipelinedStartStop();
+  
+  return EXIT_SUCCESS;
+}
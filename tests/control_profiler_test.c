@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+#include "control_profiler.h"
+#include "test_check.h"
+
+#include <pthread.h>
+
+#define SUB_BUCKETS_NUMBER 256
+#define MAX_VALUE ( ( UINT64_C(1) << 40 ) - 1 )
+#define UNIFORM_VALUES_NUMBER 100000
+#define THREADS_NUMBER 4
+#define THREAD_VALUES_NUMBER 100000
+
+// Gets reported value of the histogram bucket containing the given one, isolated from the maximum value clamping by a larger record
+static uint64_t GetReportedValue( LatencyHistogram histogram, uint64_t value )
+{
+  LatencyHistogram_Reset( histogram );
+  LatencyHistogram_Record( histogram, value );
+  LatencyHistogram_Record( histogram, UINT64_MAX );
+  return LatencyHistogram_GetPercentile( histogram, 50.0 );
+}
+
+static void TestEmptyHistogram( void )
+{
+  LatencyHistogram histogram = LatencyHistogram_Create();
+  TEST_CHECK( histogram != NULL );
+  
+  TEST_CHECK( LatencyHistogram_GetCount( histogram ) == 0 );
+  TEST_CHECK( LatencyHistogram_GetMax( histogram ) == 0 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 50.0 ) == 0 );
+  
+  LatencyHistogram_Record( histogram, 1000 );
+  LatencyHistogram_Reset( histogram );
+  TEST_CHECK( LatencyHistogram_GetCount( histogram ) == 0 );
+  TEST_CHECK( LatencyHistogram_GetMax( histogram ) == 0 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 100.0 ) == 0 );
+  
+  LatencyHistogram_Discard( histogram );
+}
+
+static void TestBucketMapping( void )
+{
+  LatencyHistogram histogram = LatencyHistogram_Create();
+  
+  // Exact values in the linear range
+  for( uint64_t value = 0; value < SUB_BUCKETS_NUMBER; value++ )
+    TEST_CHECK( GetReportedValue( histogram, value ) == value );
+  
+  // Each bucket reports its highest value, less than 1/128 above the recorded one, and the next value falls in the following bucket
+  uint64_t bucketsCount = 0;
+  for( uint64_t value = SUB_BUCKETS_NUMBER; value < 1000000; )
+  {
+    uint64_t reportedValue = GetReportedValue( histogram, value );
+    TEST_CHECK( reportedValue >= value );
+    TEST_CHECK( ( reportedValue - value ) * 128 < value );
+    TEST_CHECK( GetReportedValue( histogram, reportedValue ) == reportedValue );
+    TEST_CHECK( GetReportedValue( histogram, reportedValue + 1 ) > reportedValue );
+    value = reportedValue + 1;
+    bucketsCount++;
+  }
+  // 128 buckets per power of 2 above the linear range: 2^18 < 1000000 < 2^20
+  TEST_CHECK( bucketsCount > 10 * 128 && bucketsCount <= 12 * 128 );
+  
+  // Power of 2 edges
+  for( int bit = 8; bit < 40; bit++ )
+  {
+    uint64_t edgeValue = UINT64_C(1) << bit;
+    TEST_CHECK( GetReportedValue( histogram, edgeValue - 1 ) == edgeValue - 1 );
+    TEST_CHECK( GetReportedValue( histogram, edgeValue ) == edgeValue + ( UINT64_C(1) << ( bit - 7 ) ) - 1 );
+  }
+  
+  // Values beyond the 40 bits range are counted in the last bucket
+  TEST_CHECK( GetReportedValue( histogram, MAX_VALUE ) == MAX_VALUE );
+  TEST_CHECK( GetReportedValue( histogram, MAX_VALUE + 1 ) == MAX_VALUE );
+  TEST_CHECK( GetReportedValue( histogram, UINT64_C(1) << 50 ) == MAX_VALUE );
+  
+  LatencyHistogram_Discard( histogram );
+}
+
+static void TestPercentiles( void )
+{
+  LatencyHistogram histogram = LatencyHistogram_Create();
+  
+  // Single value: all percentiles are limited to the exact maximum
+  LatencyHistogram_Record( histogram, 123456 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 0.0 ) == 123456 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 99.9 ) == 123456 );
+  
+  // Uniform distribution from 1 to UNIFORM_VALUES_NUMBER
+  LatencyHistogram_Reset( histogram );
+  for( uint64_t value = UNIFORM_VALUES_NUMBER; value > 0; value-- )
+    LatencyHistogram_Record( histogram, value );
+  TEST_CHECK( LatencyHistogram_GetCount( histogram ) == UNIFORM_VALUES_NUMBER );
+  TEST_CHECK( LatencyHistogram_GetMax( histogram ) == UNIFORM_VALUES_NUMBER );
+  const double PERCENTILES_LIST[] = { 0.0, 1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0 };
+  for( size_t percentileIndex = 0; percentileIndex < sizeof(PERCENTILES_LIST) / sizeof(double); percentileIndex++ )
+  {
+    uint64_t exactValue = (uint64_t) ( PERCENTILES_LIST[ percentileIndex ] / 100.0 * UNIFORM_VALUES_NUMBER + 0.5 );
+    if( exactValue == 0 ) exactValue = 1;
+    uint64_t percentileValue = LatencyHistogram_GetPercentile( histogram, PERCENTILES_LIST[ percentileIndex ] );
+    TEST_CHECK( percentileValue >= exactValue );
+    TEST_CHECK( ( percentileValue - exactValue ) * 128 < exactValue );
+  }
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 100.0 ) == UNIFORM_VALUES_NUMBER );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 150.0 ) == UNIFORM_VALUES_NUMBER );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, -1.0 ) == 1 );
+  
+  // Bimodal distribution: 99% of fast steps and 1% of 1000 times slower ones
+  LatencyHistogram_Reset( histogram );
+  for( size_t valueIndex = 0; valueIndex < 10000; valueIndex++ )
+    LatencyHistogram_Record( histogram, ( valueIndex % 100 == 0 ) ? 50000000 : 50000 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 50.0 ) >= 50000 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 99.0 ) < 50000 + 50000 / 128 );
+  TEST_CHECK( LatencyHistogram_GetPercentile( histogram, 99.5 ) == 50000000 );
+  TEST_CHECK( LatencyHistogram_GetMax( histogram ) == 50000000 );
+  
+  LatencyHistogram_Discard( histogram );
+}
+
+static void* RecordValues( void* histogram )
+{
+  for( uint64_t value = 1; value <= THREAD_VALUES_NUMBER; value++ )
+    LatencyHistogram_Record( (LatencyHistogram) histogram, value );
+  return NULL;
+}
+
+static void TestConcurrentRecords( void )
+{
+  LatencyHistogram histogram = LatencyHistogram_Create();
+  
+  pthread_t threadsList[ THREADS_NUMBER ];
+  for( size_t threadIndex = 0; threadIndex < THREADS_NUMBER; threadIndex++ )
+    TEST_CHECK( pthread_create( &(threadsList[ threadIndex ]), NULL, RecordValues, histogram ) == 0 );
+  for( size_t threadIndex = 0; threadIndex < THREADS_NUMBER; threadIndex++ )
+    pthread_join( threadsList[ threadIndex ], NULL );
+  
+  TEST_CHECK( LatencyHistogram_GetCount( histogram ) == THREADS_NUMBER * THREAD_VALUES_NUMBER );
+  TEST_CHECK( LatencyHistogram_GetMax( histogram ) == THREAD_VALUES_NUMBER );
+  uint64_t medianValue = LatencyHistogram_GetPercentile( histogram, 50.0 );
+  TEST_CHECK( medianValue >= THREAD_VALUES_NUMBER / 2 && ( medianValue - THREAD_VALUES_NUMBER / 2 ) * 128 < THREAD_VALUES_NUMBER / 2 );
+  
+  LatencyHistogram_Discard( histogram );
+}
+
+int main( void )
+{
+  TestEmptyHistogram();
+  TestBucketMapping();
+  TestPercentiles();
+  TestConcurrentRecords();
+  
+  return EXIT_SUCCESS;
+}
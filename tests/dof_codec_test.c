@@ -0,0 +1,288 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "dof_codec.h"
+#include "test_check.h"
+
+#include <math.h>
+#include <string.h>
+
+#define DOFS_NUMBER 12
+#define STEP_FREQUENCY 4000.0
+#define KEYFRAME_INTERVAL 400                 // 100 ms at 4 kHz
+#define STREAM_FRAMES_NUMBER 4000
+
+static const DoFVariables PRECISION = { .position = 1e-5, .velocity = 1e-4, .force = 1e-3, .acceleration = 1e-3, 
+                                        .inertia = 1e-4, .stiffness = 1e-2, .damping = 1e-3 };
+
+typedef struct StepData
+{
+  DoFVariables variables[ DOFS_NUMBER ];
+  DoFVariables* list[ DOFS_NUMBER ];
+}
+StepData;
+
+static void InitStep( StepData* step )
+{
+  for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+  {
+    step->variables[ dofIndex ] = (DoFVariables) { 0 };
+    step->list[ dofIndex ] = &(step->variables[ dofIndex ]);
+  }
+}
+
+// Fixed synthetic robot motion: slow sinusoids with different frequencies and phases per DoF, and constant physical parameters
+static void SetSyntheticStep( StepData* step, size_t stepIndex )
+{
+  double time = stepIndex / STEP_FREQUENCY;
+  for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+  {
+    double frequency = 2.0 * M_PI * ( 0.5 + 0.1 * dofIndex ), phase = 0.3 * dofIndex;
+    DoFVariables* dof = &(step->variables[ dofIndex ]);
+    dof->position = 0.8 * sin( frequency * time + phase );
+    dof->velocity = 0.8 * frequency * cos( frequency * time + phase );
+    dof->acceleration = -0.8 * frequency * frequency * sin( frequency * time + phase );
+    dof->force = 5.0 * dof->acceleration + 2.0 * dof->velocity;
+    dof->inertia = 0.5 + 0.01 * dofIndex;
+    dof->stiffness = 100.0;
+    dof->damping = 2.0;
+  }
+}
+
+static void CheckError( const StepData* decoded, const StepData* original )
+{
+  // Quantization error bound, with margin for rounding of the reconstructed value itself
+  const double MARGIN = 1.0 + 1e-9;
+  for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+  {
+    const DoFVariables* value = &(decoded->variables[ dofIndex ]);
+    const DoFVariables* reference = &(original->variables[ dofIndex ]);
+    TEST_CHECK( fabs( value->position - reference->position ) <= PRECISION.position / 2.0 * MARGIN );
+    TEST_CHECK( fabs( value->velocity - reference->velocity ) <= PRECISION.velocity / 2.0 * MARGIN );
+    TEST_CHECK( fabs( value->force - reference->force ) <= PRECISION.force / 2.0 * MARGIN );
+    TEST_CHECK( fabs( value->acceleration - reference->acceleration ) <= PRECISION.acceleration / 2.0 * MARGIN );
+    TEST_CHECK( fabs( value->inertia - reference->inertia ) <= PRECISION.inertia / 2.0 * MARGIN );
+    TEST_CHECK( fabs( value->stiffness - reference->stiffness ) <= PRECISION.stiffness / 2.0 * MARGIN );
+    TEST_CHECK( fabs( value->damping - reference->damping ) <= PRECISION.damping / 2.0 * MARGIN );
+  }
+}
+
+// Error stays within half of precision over the whole stream, which is compressed to less than a tenth of its raw size
+static void TestRoundTrip( void )
+{
+  DoFEncoder encoder = DoFEncoder_Create( DOFS_NUMBER, &PRECISION, KEYFRAME_INTERVAL );
+  DoFDecoder decoder = DoFDecoder_Create( DOFS_NUMBER, &PRECISION );
+  TEST_CHECK( encoder != NULL && decoder != NULL );
+  StepData original, decoded;
+  InitStep( &original );
+  InitStep( &decoded );
+  uint8_t frame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  
+  size_t framesSize = 0;
+  for( size_t stepIndex = 0; stepIndex < STREAM_FRAMES_NUMBER; stepIndex++ )
+  {
+    SetSyntheticStep( &original, stepIndex );
+    size_t frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+    TEST_CHECK( frameSize > 0 );
+    framesSize += frameSize;
+    TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+    CheckError( &decoded, &original );
+  }
+  TEST_CHECK( DoFDecoder_GetLostFramesCount( decoder ) == 0 );
+  
+  size_t rawSize = STREAM_FRAMES_NUMBER * DOFS_NUMBER * sizeof(DoFVariables);
+  printf( "average frame size: %zu bytes (raw step size: %zu bytes)\n", framesSize / STREAM_FRAMES_NUMBER, DOFS_NUMBER * sizeof(DoFVariables) );
+  TEST_CHECK( framesSize * 10 < rawSize );
+  
+  DoFEncoder_Discard( encoder );
+  DoFDecoder_Discard( decoder );
+}
+
+// Fields of zero precision are neither encoded nor written
+static void TestSkippedFields( void )
+{
+  const DoFVariables positionPrecision = { .position = 1e-3 };
+  DoFEncoder encoder = DoFEncoder_Create( DOFS_NUMBER, &positionPrecision, 0 );
+  DoFDecoder decoder = DoFDecoder_Create( DOFS_NUMBER, &positionPrecision );
+  StepData original, decoded;
+  InitStep( &original );
+  InitStep( &decoded );
+  SetSyntheticStep( &original, 1 );
+  decoded.variables[ 0 ].velocity = -1.0;
+  uint8_t frame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  
+  size_t frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+  TEST_CHECK( frameSize > 0 && frameSize < 3 + DOFS_NUMBER * sizeof(double) );
+  TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+  TEST_CHECK( fabs( decoded.variables[ 3 ].position - original.variables[ 3 ].position ) <= 0.5e-3 * ( 1.0 + 1e-9 ) );
+  TEST_CHECK( decoded.variables[ 0 ].velocity == -1.0 );
+  
+  DoFEncoder_Discard( encoder );
+  DoFDecoder_Discard( decoder );
+}
+
+// Delta frames after a lost one are rejected (instead of decoded with a wrong reference) until the next keyframe
+static void TestDroppedFrame( void )
+{
+  const size_t INTERVAL = 10;
+  DoFEncoder encoder = DoFEncoder_Create( DOFS_NUMBER, &PRECISION, INTERVAL );
+  DoFDecoder decoder = DoFDecoder_Create( DOFS_NUMBER, &PRECISION );
+  StepData original, decoded;
+  InitStep( &original );
+  InitStep( &decoded );
+  uint8_t frame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  
+  for( size_t stepIndex = 0; stepIndex <= INTERVAL; stepIndex++ )
+  {
+    SetSyntheticStep( &original, stepIndex * 100 );
+    size_t frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+    if( stepIndex == 5 ) continue;
+    bool isDecoded = DoFDecoder_Decode( decoder, frame, frameSize, decoded.list );
+    TEST_CHECK( isDecoded == ( stepIndex < 5 || stepIndex == INTERVAL ) );
+    if( isDecoded ) CheckError( &decoded, &original );
+  }
+  // Frames 5 to 9 were never decoded
+  TEST_CHECK( DoFDecoder_GetLostFramesCount( decoder ) == 5 );
+  
+  DoFEncoder_Discard( encoder );
+  DoFDecoder_Discard( decoder );
+}
+
+// Truncated and malformed frames are rejected without changing the decoder reference
+static void TestMalformedFrames( void )
+{
+  DoFEncoder encoder = DoFEncoder_Create( DOFS_NUMBER, &PRECISION, 0 );
+  DoFDecoder decoder = DoFDecoder_Create( DOFS_NUMBER, &PRECISION );
+  StepData original, decoded;
+  InitStep( &original );
+  InitStep( &decoded );
+  uint8_t frame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  
+  for( size_t stepIndex = 0; stepIndex < 3; stepIndex++ )
+  {
+    SetSyntheticStep( &original, stepIndex );
+    size_t frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+    TEST_CHECK( !DoFDecoder_Decode( decoder, frame, 2, decoded.list ) );
+    TEST_CHECK( !DoFDecoder_Decode( decoder, frame, frameSize - 1, decoded.list ) );
+    TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+    CheckError( &decoded, &original );
+  }
+  TEST_CHECK( DoFDecoder_GetLostFramesCount( decoder ) == 0 );
+  
+  // Keyframe whose first field width is larger than 64 bits
+  uint8_t invalidFrame[ 16 ] = { 0x01, 0x00, 0x00, 0x7F };
+  TEST_CHECK( !DoFDecoder_Decode( decoder, invalidFrame, sizeof(invalidFrame), decoded.list ) );
+  SetSyntheticStep( &original, 3 );
+  size_t frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+  TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+  CheckError( &decoded, &original );
+  
+  // Encoding into a too small buffer fails, keeping encoder state
+  TEST_CHECK( DoFEncoder_Encode( encoder, original.list, frame, 8 ) == 0 );
+  frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+  TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+  
+  DoFEncoder_Discard( encoder );
+  DoFDecoder_Discard( decoder );
+}
+
+// Decoder resumes at the first keyframe of a restarted encoder, whose sequence is far behind, and follows sequence wrap arounds
+static void TestEncoderRestart( void )
+{
+  DoFEncoder encoder = DoFEncoder_Create( DOFS_NUMBER, &PRECISION, 0 );
+  DoFDecoder decoder = DoFDecoder_Create( DOFS_NUMBER, &PRECISION );
+  StepData original, decoded;
+  InitStep( &original );
+  InitStep( &decoded );
+  uint8_t frame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  uint8_t lastFrame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  size_t frameSize = 0;
+  
+  for( size_t stepIndex = 0; stepIndex < 20000; stepIndex++ )
+  {
+    SetSyntheticStep( &original, stepIndex );
+    frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+    TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+  }
+  memcpy( lastFrame, frame, frameSize );
+  size_t lastFrameSize = frameSize;
+  
+  DoFEncoder_Discard( encoder );
+  encoder = DoFEncoder_Create( DOFS_NUMBER, &PRECISION, 0 );
+  // More than the 16-bit sequence range, without keyframes after the first one
+  for( size_t stepIndex = 0; stepIndex < 70000; stepIndex++ )
+  {
+    SetSyntheticStep( &original, stepIndex + 7 );
+    frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+    TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+    CheckError( &decoded, &original );
+  }
+  TEST_CHECK( DoFDecoder_GetLostFramesCount( decoder ) == 0 );
+  
+  // Delta frames of the old sequence are still ignored
+  TEST_CHECK( !DoFDecoder_Decode( decoder, lastFrame, lastFrameSize, decoded.list ) );
+  
+  DoFEncoder_Discard( encoder );
+  DoFDecoder_Discard( decoder );
+}
+
+// Values beyond quantization range are saturated (with full range deltas between them) and NaNs taken as 0
+static void TestSaturation( void )
+{
+  const DoFVariables positionPrecision = { .position = 1e-5 };
+  const double MAX_VALUE = 4611686018427387904.0 * 1e-5;
+  const double VALUES_LIST[] = { 1e30, 0.0, -1e30, 1e30, NAN, -INFINITY, 1.0 };
+  const double DECODED_VALUES_LIST[] = { MAX_VALUE, 0.0, -MAX_VALUE, MAX_VALUE, 0.0, -MAX_VALUE, 1.0 };
+  DoFEncoder encoder = DoFEncoder_Create( DOFS_NUMBER, &positionPrecision, 0 );
+  DoFDecoder decoder = DoFDecoder_Create( DOFS_NUMBER, &positionPrecision );
+  StepData original, decoded;
+  InitStep( &original );
+  InitStep( &decoded );
+  uint8_t frame[ DoFCodec_GetMaxFrameSize( DOFS_NUMBER ) ];
+  
+  for( size_t valueIndex = 0; valueIndex < sizeof(VALUES_LIST) / sizeof(double); valueIndex++ )
+  {
+    for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+      original.variables[ dofIndex ].position = ( dofIndex % 2 == 0 ) ? VALUES_LIST[ valueIndex ] : 0.5;
+    size_t frameSize = DoFEncoder_Encode( encoder, original.list, frame, sizeof(frame) );
+    TEST_CHECK( DoFDecoder_Decode( decoder, frame, frameSize, decoded.list ) );
+    for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+    {
+      double value = ( dofIndex % 2 == 0 ) ? DECODED_VALUES_LIST[ valueIndex ] : 0.5;
+      TEST_CHECK( fabs( decoded.variables[ dofIndex ].position - value ) <= fabs( value ) * 1e-12 + 0.5e-5 );
+    }
+  }
+  
+  DoFEncoder_Discard( encoder );
+  DoFDecoder_Discard( decoder );
+}
+
+int main( void )
+{
+  TestRoundTrip();
+  TestSkippedFields();
+  TestDroppedFrame();
+  TestMalformedFrames();
+  TestEncoderRestart();
+  TestSaturation();
+  
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "dof_stream.h"
+#include "test_check.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DOFS_NUMBER 6
+#define BATCH_STEPS_NUMBER 4
+#define PACKETS_NUMBER 6
+#define MAX_RECEIVE_TRIES 1000
+
+static DoFVariables variablesList[ DOFS_NUMBER ], receivedVariablesList[ DOFS_NUMBER ];
+static DoFVariables* variablesReferences[ DOFS_NUMBER ], * receivedVariablesReferences[ DOFS_NUMBER ];
+
+static void SetStepVariables( uint32_t sequence )
+{
+  for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+  {
+    variablesList[ dofIndex ].position = sequence * 0.5 + dofIndex;
+    variablesList[ dofIndex ].velocity = -1.0 * sequence;
+    variablesList[ dofIndex ].stiffness = 100.0 + sequence;
+  }
+}
+
+// Decodes all received steps (waiting for the first one), checking that only sent fields are written
+static size_t ReceiveSteps( DoFStreamReceiver receiver, uint32_t* sequencesList, size_t maxStepsNumber )
+{
+  size_t stepsNumber = 0;
+  for( size_t tryIndex = 0; tryIndex < MAX_RECEIVE_TRIES && stepsNumber == 0; tryIndex++ )
+  {
+    uint64_t timestamp;
+    for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+      receivedVariablesList[ dofIndex ].stiffness = -1.0;
+    while( stepsNumber < maxStepsNumber && DoFStreamReceiver_ReceiveStep( receiver, receivedVariablesReferences, &timestamp ) )
+    {
+      uint32_t sequence = DoFStreamReceiver_GetSequence( receiver );
+      TEST_CHECK( timestamp == 1000 + sequence );
+      TEST_CHECK( DoFStreamReceiver_GetFieldsMask( receiver ) == ( DOF_POSITION | DOF_VELOCITY ) );
+      for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+      {
+        TEST_CHECK( receivedVariablesList[ dofIndex ].position == sequence * 0.5 + dofIndex );
+        TEST_CHECK( receivedVariablesList[ dofIndex ].velocity == -1.0 * sequence );
+        TEST_CHECK( receivedVariablesList[ dofIndex ].stiffness == -1.0 );
+      }
+      sequencesList[ stepsNumber++ ] = sequence;
+    }
+    struct timespec waitTime = { .tv_sec = 0, .tv_nsec = 100000 };
+    nanosleep( &waitTime, NULL );
+  }
+  
+  return stepsNumber;
+}
+
+int main( void )
+{
+  for( size_t dofIndex = 0; dofIndex < DOFS_NUMBER; dofIndex++ )
+  {
+    variablesReferences[ dofIndex ] = &(variablesList[ dofIndex ]);
+    receivedVariablesReferences[ dofIndex ] = &(receivedVariablesList[ dofIndex ]);
+  }
+  
+  DoFStreamReceiver receiver = DoFStreamReceiver_Create( "127.0.0.1", 0, DOFS_NUMBER );
+  TEST_CHECK( receiver != NULL && DoFStreamReceiver_GetPort( receiver ) != 0 );
+  struct sockaddr_in receiverAddress = { .sin_family = AF_INET, .sin_port = htons( DoFStreamReceiver_GetPort( receiver ) ), 
+                                         .sin_addr.s_addr = htonl( INADDR_LOOPBACK ) };
+  
+  // Relay socket between sender and receiver, dropping, delaying and duplicating datagrams
+  int relaySocket = socket( AF_INET, SOCK_DGRAM, 0 );
+  struct sockaddr_in relayAddress = { .sin_family = AF_INET, .sin_addr.s_addr = htonl( INADDR_LOOPBACK ) };
+  socklen_t addressLength = sizeof(relayAddress);
+  TEST_CHECK( bind( relaySocket, (struct sockaddr*) &relayAddress, sizeof(relayAddress) ) == 0 );
+  TEST_CHECK( getsockname( relaySocket, (struct sockaddr*) &relayAddress, &addressLength ) == 0 );
+  
+  TEST_CHECK( DoFStreamSender_Create( "127.0.0.1", ntohs( relayAddress.sin_port ), DOFS_NUMBER, DOF_ALL_VARIABLES, 10000 ) == NULL );
+  DoFStreamSender sender = DoFStreamSender_Create( "127.0.0.1", ntohs( relayAddress.sin_port ), DOFS_NUMBER, DOF_POSITION | DOF_VELOCITY, BATCH_STEPS_NUMBER );
+  TEST_CHECK( sender != NULL );
+  size_t packetSize = DoFStream_GetPacketSize( DOFS_NUMBER, DOF_POSITION | DOF_VELOCITY, BATCH_STEPS_NUMBER );
+  
+  static uint8_t packetsList[ PACKETS_NUMBER ][ DOF_STREAM_MAX_PACKET_SIZE ];
+  for( uint32_t sequence = 0; sequence < PACKETS_NUMBER * BATCH_STEPS_NUMBER; sequence++ )
+  {
+    SetStepVariables( sequence );
+    TEST_CHECK( DoFStreamSender_AddStep( sender, variablesReferences, 1000 + sequence ) );
+    if( ( sequence + 1 ) % BATCH_STEPS_NUMBER > 0 ) continue;
+    struct pollfd relay = { .fd = relaySocket, .events = POLLIN };
+    TEST_CHECK( poll( &relay, 1, 1000 ) == 1 );
+    TEST_CHECK( recv( relaySocket, packetsList[ sequence / BATCH_STEPS_NUMBER ], DOF_STREAM_MAX_PACKET_SIZE, 0 ) == (ssize_t) packetSize );
+  }
+  
+  // Packet 1 is lost, 3 arrives after 4 (stale), 4 is duplicated, and some garbage arrives before 5
+  const size_t FORWARDED_PACKETS_LIST[] = { 0, 2, 4, 4, 3, PACKETS_NUMBER, 5 };
+  for( size_t forwardIndex = 0; forwardIndex < sizeof(FORWARDED_PACKETS_LIST) / sizeof(size_t); forwardIndex++ )
+  {
+    size_t packetIndex = FORWARDED_PACKETS_LIST[ forwardIndex ];
+    const void* packet = ( packetIndex < PACKETS_NUMBER ) ? packetsList[ packetIndex ] : (const void*) "garbage";
+    size_t forwardedSize = ( packetIndex < PACKETS_NUMBER ) ? packetSize : 7;
+    TEST_CHECK( sendto( relaySocket, packet, forwardedSize, 0, (struct sockaddr*) &receiverAddress, sizeof(receiverAddress) ) == (ssize_t) forwardedSize );
+  }
+  
+  uint32_t sequencesList[ PACKETS_NUMBER * BATCH_STEPS_NUMBER ];
+  const uint32_t EXPECTED_SEQUENCES_LIST[] = { 0, 1, 2, 3, 8, 9, 10, 11, 16, 17, 18, 19, 20, 21, 22, 23 };
+  size_t stepsNumber = ReceiveSteps( receiver, sequencesList, PACKETS_NUMBER * BATCH_STEPS_NUMBER );
+  TEST_CHECK( stepsNumber == sizeof(EXPECTED_SEQUENCES_LIST) / sizeof(uint32_t) );
+  TEST_CHECK( memcmp( sequencesList, EXPECTED_SEQUENCES_LIST, sizeof(EXPECTED_SEQUENCES_LIST) ) == 0 );
+  TEST_CHECK( DoFStreamReceiver_GetLostStepsCount( receiver ) == 2 * BATCH_STEPS_NUMBER );
+  TEST_CHECK( DoFStreamReceiver_GetDroppedPacketsCount( receiver ) == 3 );
+  
+  // Restarted sender (new sequence), flushing an incomplete batch straight to the receiver
+  DoFStreamSender_Discard( sender );
+  sender = DoFStreamSender_Create( "127.0.0.1", DoFStreamReceiver_GetPort( receiver ), DOFS_NUMBER, DOF_POSITION | DOF_VELOCITY, BATCH_STEPS_NUMBER );
+  TEST_CHECK( sender != NULL );
+  for( uint32_t sequence = 0; sequence < 2; sequence++ )
+  {
+    SetStepVariables( sequence );
+    TEST_CHECK( DoFStreamSender_AddStep( sender, variablesReferences, 1000 + sequence ) );
+  }
+  TEST_CHECK( DoFStreamSender_Flush( sender ) );
+  stepsNumber = ReceiveSteps( receiver, sequencesList, PACKETS_NUMBER * BATCH_STEPS_NUMBER );
+  TEST_CHECK( stepsNumber == 2 && sequencesList[ 0 ] == 0 && sequencesList[ 1 ] == 1 );
+  TEST_CHECK( DoFStreamReceiver_GetLostStepsCount( receiver ) == 2 * BATCH_STEPS_NUMBER );
+  
+  DoFStreamSender_Discard( sender );
+  DoFStreamReceiver_Discard( receiver );
+  close( relaySocket );
+  
+  return EXIT_SUCCESS;
+}
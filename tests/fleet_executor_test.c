@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "fleet_executor.h"
+#include "test_check.h"
+
+#include <time.h>
+
+#define WORKERS_NUMBER 2
+#define FAST_ROBOTS_NUMBER 4
+#define FAST_STEP_PERIOD 0.005
+#define SLOW_STEP_PERIOD 0.1
+#define SLOW_STEP_DURATION 0.05
+#define RUN_TIME 0.5
+
+static void RunFastStep( void* stepData, double timeDelta )
+{
+  (void) stepData;
+  (void) timeDelta;
+}
+
+// Blocks its owner worker (without using the CPU, so that this also works on single CPU machines) for several fast robot periods
+static void RunSlowStep( void* stepData, double timeDelta )
+{
+  (void) stepData;
+  (void) timeDelta;
+  struct timespec stepTime = { .tv_sec = 0, .tv_nsec = (long) ( SLOW_STEP_DURATION * 1e9 ) };
+  nanosleep( &stepTime, NULL );
+}
+
+static void Wait( double time )
+{
+  struct timespec waitTime = { .tv_sec = (time_t) time, .tv_nsec = (long) ( ( time - (time_t) time ) * 1e9 ) };
+  nanosleep( &waitTime, NULL );
+}
+
+static uint64_t GetStolenStepsCount( FleetExecutor executor )
+{
+  uint64_t stolenStepsCount = 0;
+  for( size_t workerIndex = 0; workerIndex < FleetExecutor_GetWorkersNumber( executor ); workerIndex++ )
+  {
+    FleetWorkerStatus status;
+    TEST_CHECK( FleetExecutor_GetWorkerStatus( executor, workerIndex, &status ) );
+    stolenStepsCount += status.stolenStepsCount;
+  }
+  
+  return stolenStepsCount;
+}
+
+// Fast robots sharing a worker with a slow one are stolen while it runs, keeping their periods, and returned to their owner afterwards
+static void TestWorkStealing( void )
+{
+  FleetExecutorSettings settings = { .workersNumber = WORKERS_NUMBER };
+  FleetExecutor executor = FleetExecutor_Create( &settings );
+  TEST_CHECK( executor != NULL );
+  
+  int fastRobotsList[ FAST_ROBOTS_NUMBER ];
+  for( size_t robotIndex = 0; robotIndex < FAST_ROBOTS_NUMBER; robotIndex++ )
+  {
+    fastRobotsList[ robotIndex ] = FleetExecutor_AddRobot( executor, FAST_STEP_PERIOD, RunFastStep, NULL );
+    TEST_CHECK( fastRobotsList[ robotIndex ] >= 0 );
+  }
+  int slowRobot = FleetExecutor_AddRobot( executor, SLOW_STEP_PERIOD, RunSlowStep, NULL );
+  TEST_CHECK( slowRobot >= 0 );
+  TEST_CHECK( FleetExecutor_Start( executor ) );
+  TEST_CHECK( FleetExecutor_GetWorkersNumber( executor ) == WORKERS_NUMBER );
+  
+  Wait( RUN_TIME / 2 );
+  TEST_CHECK( GetStolenStepsCount( executor ) > 0 );
+  
+  // Robots keep running after steal and return cycles
+  FleetRobotStatus robotStatusList[ FAST_ROBOTS_NUMBER + 1 ];
+  for( size_t robotIndex = 0; robotIndex <= FAST_ROBOTS_NUMBER; robotIndex++ )
+    TEST_CHECK( FleetExecutor_GetRobotStatus( executor, robotIndex, &(robotStatusList[ robotIndex ]) ) );
+  Wait( RUN_TIME );
+  for( size_t robotIndex = 0; robotIndex <= FAST_ROBOTS_NUMBER; robotIndex++ )
+  {
+    FleetRobotStatus status;
+    TEST_CHECK( FleetExecutor_GetRobotStatus( executor, robotIndex, &status ) );
+    double stepPeriod = ( (int) robotIndex == slowRobot ) ? SLOW_STEP_PERIOD : FAST_STEP_PERIOD;
+    uint64_t stepsNumber = (uint64_t) ( RUN_TIME / stepPeriod );
+    uint64_t stepsCount = status.stepsCount - robotStatusList[ robotIndex ].stepsCount;
+    uint64_t deadlineMissesCount = status.deadlineMissesCount - robotStatusList[ robotIndex ].deadlineMissesCount;
+    // Without stealing, fast robots owned by the slow robot worker would be released up to a slow step duration late, 
+    // skipping the steps of that time. Bounds are loose otherwise, as test machines may stall threads for a few milliseconds
+    TEST_CHECK( stepsCount >= stepsNumber * 8 / 10 && stepsCount <= stepsNumber + 2 );
+    if( (int) robotIndex != slowRobot )
+    {
+      TEST_CHECK( status.maxReleaseLatency < SLOW_STEP_DURATION / 2 );
+      TEST_CHECK( deadlineMissesCount <= stepsNumber / 10 );
+    }
+  }
+  
+  FleetExecutor_Discard( executor );
+}
+
+int main( void )
+{
+  TestWorkStealing();
+  
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+
+#include "plugin_host.h"
+#include "plugin_bridge.h"
+#include "test_check.h"
+
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define ROGUE_HOST_MODE "rogue"
+
+static const char* hostPath;
+static const char* pluginPath;
+
+static double GetTime( void )
+{
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Hosted process replacing robot_control_host, which answers every call writing out of range counts and unterminated names
+static int RunRogueHost( int bridgeFD )
+{
+  PluginBridge* bridge = (PluginBridge*) mmap( NULL, sizeof(PluginBridge), PROT_READ | PROT_WRITE, MAP_SHARED, bridgeFD, 0 );
+  if( bridge == MAP_FAILED ) return EXIT_FAILURE;
+  
+  pid_t clientPID = getppid();
+  bool isRunning = true;
+  while( isRunning && getppid() == clientPID )
+  {
+    if( !PluginBridge_WaitState( bridge, PLUGIN_BRIDGE_CALL, 100000000LL ) ) continue;
+    bridge->jointsNumber = bridge->extraInputsNumber = bridge->extraOutputsNumber = UINT32_MAX;
+    bridge->axesNumber = PLUGIN_BRIDGE_MAX_DOFS + 1;
+    bridge->returnValue = UINT32_MAX;
+    bridge->hasNames = 1;
+    memset( bridge->namesList, 'x', sizeof(bridge->namesList) );
+    isRunning = ( bridge->call != PLUGIN_BRIDGE_EXIT );
+    PluginBridge_SetState( bridge, PLUGIN_BRIDGE_RETURN );
+  }
+  
+  return EXIT_SUCCESS;
+}
+
+// Lists of one DoF more than bridge capacity, whose last element must never be written
+typedef struct StepData
+{
+  DoFVariables jointMeasures[ PLUGIN_BRIDGE_MAX_DOFS + 1 ], axisMeasures[ PLUGIN_BRIDGE_MAX_DOFS + 1 ];
+  DoFVariables jointSetpoints[ PLUGIN_BRIDGE_MAX_DOFS + 1 ], axisSetpoints[ PLUGIN_BRIDGE_MAX_DOFS + 1 ];
+  DoFVariables* jointMeasuresList[ PLUGIN_BRIDGE_MAX_DOFS + 1 ], * axisMeasuresList[ PLUGIN_BRIDGE_MAX_DOFS + 1 ];
+  DoFVariables* jointSetpointsList[ PLUGIN_BRIDGE_MAX_DOFS + 1 ], * axisSetpointsList[ PLUGIN_BRIDGE_MAX_DOFS + 1 ];
+}
+StepData;
+
+static void InitStep( StepData* step )
+{
+  memset( step, 0, sizeof(StepData) );
+  for( size_t dofIndex = 0; dofIndex <= PLUGIN_BRIDGE_MAX_DOFS; dofIndex++ )
+  {
+    step->jointMeasuresList[ dofIndex ] = &(step->jointMeasures[ dofIndex ]);
+    step->axisMeasuresList[ dofIndex ] = &(step->axisMeasures[ dofIndex ]);
+    step->jointSetpointsList[ dofIndex ] = &(step->jointSetpoints[ dofIndex ]);
+    step->axisSetpointsList[ dofIndex ] = &(step->axisSetpoints[ dofIndex ]);
+  }
+}
+
+static void RunStep( const RobotControlFunctions* plugin, StepData* step, double timeDelta )
+{
+  plugin->RunControlStep( step->jointMeasuresList, step->axisMeasuresList, step->jointSetpointsList, step->axisSetpointsList, timeDelta );
+}
+
+// Calls are forwarded to the plugin and their results back to the client
+static void TestRoundTrip( void )
+{
+  PluginHost host = PluginHost_Start( hostPath, pluginPath, 1.0, 5.0 );
+  TEST_CHECK( host != NULL );
+  const RobotControlFunctions* plugin = PluginHost_GetFunctions( host );
+  
+  TEST_CHECK( plugin->InitController( "" ) );
+  TEST_CHECK( plugin->GetJointsNumber() == 2 && plugin->GetAxesNumber() == 1 );
+  TEST_CHECK( plugin->GetExtraInputsNumber() == 1 && plugin->GetExtraOutputsNumber() == 1 );
+  const char** jointNamesList = plugin->GetJointNamesList();
+  TEST_CHECK( jointNamesList != NULL && strcmp( jointNamesList[ 0 ], "joint_0" ) == 0 && strcmp( jointNamesList[ 1 ], "joint_1" ) == 0 );
+  const char** axisNamesList = plugin->GetAxisNamesList();
+  TEST_CHECK( axisNamesList != NULL && strcmp( axisNamesList[ 0 ], "axis_0" ) == 0 );
+  plugin->SetControlState( CONTROL_OPERATION );
+  
+  StepData step;
+  InitStep( &step );
+  for( size_t stepIndex = 0; stepIndex < 100; stepIndex++ )
+  {
+    step.jointMeasures[ 0 ].position = stepIndex;
+    step.jointMeasures[ 1 ].position = -1.0 * stepIndex;
+    step.axisMeasures[ 0 ].force = 0.5 * stepIndex;
+    RunStep( plugin, &step, 0.001 );
+    TEST_CHECK( step.jointSetpoints[ 0 ].position == 2.0 * stepIndex + 0.001 );
+    TEST_CHECK( step.jointSetpoints[ 1 ].position == -2.0 * stepIndex + 0.001 );
+    TEST_CHECK( step.axisSetpoints[ 0 ].force == -0.5 * stepIndex );
+    TEST_CHECK( step.jointMeasures[ 0 ].position == stepIndex );
+  }
+  
+  double extraInput = 1.5, extraOutput = 0.0;
+  plugin->SetExtraInputsList( &extraInput );
+  plugin->GetExtraOutputsList( &extraOutput );
+  TEST_CHECK( extraOutput == 4.5 );
+  
+  plugin->EndController();
+  TEST_CHECK( PluginHost_IsAlive( host ) );
+  PluginHost_Stop( host );
+}
+
+// Hung calls (including controller initialization) are killed after their timeouts, without blocking the client any longer
+static void TestHungPlugin( void )
+{
+  PluginHost host = PluginHost_Start( hostPath, pluginPath, 0.1, 0.2 );
+  TEST_CHECK( host != NULL );
+  const RobotControlFunctions* plugin = PluginHost_GetFunctions( host );
+  double startTime = GetTime();
+  TEST_CHECK( !plugin->InitController( "hang_init" ) );
+  TEST_CHECK( GetTime() - startTime >= 0.2 && GetTime() - startTime < 2.0 );
+  TEST_CHECK( !PluginHost_IsAlive( host ) );
+  PluginHost_Stop( host );
+  
+  host = PluginHost_Start( hostPath, pluginPath, 0.1, 0.2 );
+  TEST_CHECK( host != NULL );
+  plugin = PluginHost_GetFunctions( host );
+  TEST_CHECK( plugin->InitController( "hang_step" ) );
+  StepData step;
+  InitStep( &step );
+  startTime = GetTime();
+  RunStep( plugin, &step, 0.001 );
+  TEST_CHECK( GetTime() - startTime >= 0.1 && GetTime() - startTime < 2.0 );
+  TEST_CHECK( !PluginHost_IsAlive( host ) );
+  // Following calls return right away
+  TEST_CHECK( plugin->GetJointsNumber() == 0 && plugin->GetJointNamesList() == NULL );
+  PluginHost_Stop( host );
+}
+
+// Crashes are detected while waiting for the call, even with no timeout, and even if the application doesn't wait for children
+static void TestCrashingPlugin( bool isChildSignalIgnored )
+{
+  signal( SIGCHLD, isChildSignalIgnored ? SIG_IGN : SIG_DFL );
+  
+  PluginHost host = PluginHost_Start( hostPath, pluginPath, 0.0, 0.0 );
+  TEST_CHECK( host != NULL );
+  const RobotControlFunctions* plugin = PluginHost_GetFunctions( host );
+  TEST_CHECK( plugin->InitController( "slow_step" ) );
+  StepData step;
+  InitStep( &step );
+  // Slow steps are waited beyond the liveness check interval of calls, without the running host being considered dead
+  for( size_t stepIndex = 0; stepIndex < 20; stepIndex++ )
+    RunStep( plugin, &step, 0.001 );
+  TEST_CHECK( PluginHost_IsAlive( host ) );
+  TEST_CHECK( step.jointSetpoints[ 0 ].position == 0.001 );
+  PluginHost_Stop( host );
+  
+  host = PluginHost_Start( hostPath, pluginPath, 0.0, 0.0 );
+  TEST_CHECK( host != NULL );
+  plugin = PluginHost_GetFunctions( host );
+  TEST_CHECK( plugin->InitController( "crash_step" ) );
+  double startTime = GetTime();
+  RunStep( plugin, &step, 0.001 );
+  TEST_CHECK( GetTime() - startTime < 2.0 );
+  TEST_CHECK( !PluginHost_IsAlive( host ) );
+  PluginHost_Stop( host );
+  
+  signal( SIGCHLD, SIG_DFL );
+}
+
+// Counts written by the hosted process are clamped to bridge capacity, and names are always terminated
+static void TestRogueHost( const char* testPath )
+{
+  PluginHost host = PluginHost_Start( testPath, ROGUE_HOST_MODE, 1.0, 1.0 );
+  TEST_CHECK( host != NULL );
+  const RobotControlFunctions* plugin = PluginHost_GetFunctions( host );
+  
+  TEST_CHECK( plugin->InitController( "" ) );
+  TEST_CHECK( plugin->GetJointsNumber() == PLUGIN_BRIDGE_MAX_DOFS && plugin->GetAxesNumber() == PLUGIN_BRIDGE_MAX_DOFS );
+  TEST_CHECK( plugin->GetExtraInputsNumber() == PLUGIN_BRIDGE_MAX_EXTRAS && plugin->GetExtraOutputsNumber() == PLUGIN_BRIDGE_MAX_EXTRAS );
+  const char** jointNamesList = plugin->GetJointNamesList();
+  TEST_CHECK( jointNamesList != NULL );
+  for( size_t jointIndex = 0; jointIndex < PLUGIN_BRIDGE_MAX_DOFS; jointIndex++ )
+    TEST_CHECK( strlen( jointNamesList[ jointIndex ] ) == PLUGIN_BRIDGE_NAME_LENGTH - 1 );
+  
+  StepData step;
+  InitStep( &step );
+  step.jointMeasures[ PLUGIN_BRIDGE_MAX_DOFS ].position = 1.0;
+  // Counts are rewritten by the hosted process on every call
+  for( size_t stepIndex = 0; stepIndex < 3; stepIndex++ )
+    RunStep( plugin, &step, 0.001 );
+  TEST_CHECK( step.jointMeasures[ PLUGIN_BRIDGE_MAX_DOFS ].position == 1.0 && step.jointSetpoints[ PLUGIN_BRIDGE_MAX_DOFS ].position == 0.0 );
+  
+  double extrasList[ PLUGIN_BRIDGE_MAX_EXTRAS + 1 ] = { 0 };
+  extrasList[ PLUGIN_BRIDGE_MAX_EXTRAS ] = -1.0;
+  plugin->SetExtraInputsList( extrasList );
+  plugin->GetExtraOutputsList( extrasList );
+  TEST_CHECK( extrasList[ PLUGIN_BRIDGE_MAX_EXTRAS ] == -1.0 );
+  
+  TEST_CHECK( PluginHost_IsAlive( host ) );
+  PluginHost_Stop( host );
+}
+
+int main( int argc, char* argv[] )
+{
+  // Started by PluginHost_Start as "<test path> <bridge fd> rogue"
+  if( argc == 3 && strcmp( argv[ 2 ], ROGUE_HOST_MODE ) == 0 ) return RunRogueHost( atoi( argv[ 1 ] ) );
+  
+  if( argc < 3 )
+  {
+    fputs( "usage: plugin_host_test <robot_control_host path> <test plugin path>\n", stderr );
+    return EXIT_FAILURE;
+  }
+  hostPath = argv[ 1 ];
+  pluginPath = argv[ 2 ];
+  
+  // Crashing plugins shouldn't leave core dumps behind
+  struct rlimit coreLimit = { 0, 0 };
+  setrlimit( RLIMIT_CORE, &coreLimit );
+  
+  TestRoundTrip();
+  TestHungPlugin();
+  TestCrashingPlugin( false );
+  TestCrashingPlugin( true );
+  TestRogueHost( "/proc/self/exe" );
+  
+  return EXIT_SUCCESS;
+}
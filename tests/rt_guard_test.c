@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+#define _GNU_SOURCE
+
+#include "rt_guard.h"
+#include "control_loop.h"
+#include "test_check.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_REPORT_LENGTH 65536
+
+enum { UNSAFE_MALLOC, UNSAFE_PRINTF, UNSAFE_MUTEX_LOCK, UNSAFE_CALLS_NUMBER };
+static const char* UNSAFE_CALL_NAMES[ UNSAFE_CALLS_NUMBER ] = { "malloc", "printf", "pthread_mutex_lock" };
+
+// Keeps allocations from being optimized out
+static void* volatile allocatedData = NULL;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int reportsFD = -1, errorFD = -1;
+
+// Standard error is redirected to a memory file while guarded calls are made, so that reports can be checked afterwards
+static void StartCapture( void )
+{
+  fflush( stderr );
+  if( reportsFD != -1 ) close( reportsFD );
+  reportsFD = memfd_create( "rt_guard_reports", 0 );
+  TEST_CHECK( reportsFD != -1 );
+  errorFD = dup( STDERR_FILENO );
+  TEST_CHECK( errorFD != -1 && dup2( reportsFD, STDERR_FILENO ) == STDERR_FILENO );
+}
+
+static void EndCapture( void )
+{
+  dup2( errorFD, STDERR_FILENO );
+  close( errorFD );
+}
+
+static bool IsReported( const char* functionName )
+{
+  static char reportsText[ MAX_REPORT_LENGTH ];
+  ssize_t reportsLength = pread( reportsFD, reportsText, sizeof(reportsText) - 1, 0 );
+  TEST_CHECK( reportsLength >= 0 );
+  reportsText[ reportsLength ] = '\0';
+  char message[ 128 ];
+  snprintf( message, sizeof(message), "RT guard: %s called during control step", functionName );
+  return ( strstr( reportsText, message ) != NULL );
+}
+
+// Gets number of violations counted for each unsafe call
+static void CallUnsafeFunctions( bool isStep, uint64_t* violationsNumbersList )
+{
+  StartCapture();
+  if( isStep ) RTGuard_EnterStep();
+  
+  uint64_t violationsCount = RTGuard_GetViolationsCount();
+  allocatedData = malloc( 64 );
+  violationsNumbersList[ UNSAFE_MALLOC ] = RTGuard_GetViolationsCount() - violationsCount;
+  
+  violationsCount = RTGuard_GetViolationsCount();
+  printf( "RT guard test output %d\n", 1 );
+  violationsNumbersList[ UNSAFE_PRINTF ] = RTGuard_GetViolationsCount() - violationsCount;
+  
+  violationsCount = RTGuard_GetViolationsCount();
+  pthread_mutex_lock( &lock );
+  violationsNumbersList[ UNSAFE_MUTEX_LOCK ] = RTGuard_GetViolationsCount() - violationsCount;
+  
+  if( isStep ) RTGuard_ExitStep();
+  pthread_mutex_unlock( &lock );
+  free( allocatedData );
+  EndCapture();
+}
+
+static void TestGuardedSection( void )
+{
+  uint64_t violationsNumbersList[ UNSAFE_CALLS_NUMBER ];
+  // Stdout buffer is allocated on first print, which shouldn't be counted as printf violation
+  printf( "RT guard test start\n" );
+  RTGuard_PrepareThread( 0 );
+  
+  // Outside control steps nothing is reported
+  CallUnsafeFunctions( false, violationsNumbersList );
+  for( size_t callIndex = 0; callIndex < UNSAFE_CALLS_NUMBER; callIndex++ )
+    TEST_CHECK( violationsNumbersList[ callIndex ] == 0 && !IsReported( UNSAFE_CALL_NAMES[ callIndex ] ) );
+  TEST_CHECK( RTGuard_GetViolationsCount() == 0 );
+  
+  // Each call is reported once inside control steps
+  CallUnsafeFunctions( true, violationsNumbersList );
+  for( size_t callIndex = 0; callIndex < UNSAFE_CALLS_NUMBER; callIndex++ )
+    TEST_CHECK( violationsNumbersList[ callIndex ] == 1 && IsReported( UNSAFE_CALL_NAMES[ callIndex ] ) );
+  TEST_CHECK( !IsReported( "free" ) );
+  TEST_CHECK( RTGuard_GetViolationsCount() == UNSAFE_CALLS_NUMBER );
+  
+  // Exiting steps stops reporting
+  CallUnsafeFunctions( false, violationsNumbersList );
+  for( size_t callIndex = 0; callIndex < UNSAFE_CALLS_NUMBER; callIndex++ )
+    TEST_CHECK( violationsNumbersList[ callIndex ] == 0 && !IsReported( UNSAFE_CALL_NAMES[ callIndex ] ) );
+  TEST_CHECK( RTGuard_GetViolationsCount() == UNSAFE_CALLS_NUMBER );
+}
+
+static void RunAllocatingStep( void* stepData, double timeDelta )
+{
+  atomic_uint_fast64_t* stepsCount = (atomic_uint_fast64_t*) stepData;
+  (void) timeDelta;
+  if( atomic_fetch_add( stepsCount, 1 ) == 0 ) allocatedData = malloc( 64 );
+}
+
+// Control loop steps are marked automatically when the guard library is linked
+static void TestGuardedLoop( void )
+{
+  atomic_uint_fast64_t stepsCount;
+  atomic_init( &stepsCount, 0 );
+  ControlLoopSettings settings = { .stepPeriod = 0.001 };
+  uint64_t violationsCount = RTGuard_GetViolationsCount();
+  
+  StartCapture();
+  ControlLoop loop = ControlLoop_Start( &settings, RunAllocatingStep, &stepsCount );
+  struct timespec waitTime = { .tv_sec = 0, .tv_nsec = 1000000 };
+  while( loop != NULL && atomic_load( &stepsCount ) < 10 ) 
+    nanosleep( &waitTime, NULL );
+  ControlLoop_Stop( loop );
+  free( allocatedData );
+  EndCapture();
+  
+  TEST_CHECK( loop != NULL );
+  TEST_CHECK( RTGuard_GetViolationsCount() == violationsCount + 1 );
+  TEST_CHECK( IsReported( "malloc" ) );
+}
+
+int main( void )
+{
+  TestGuardedSection();
+  TestGuardedLoop();
+  
+  return EXIT_SUCCESS;
+}
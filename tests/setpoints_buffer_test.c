@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "setpoints_buffer.h"
+#include "test_check.h"
+
+static void TestHandoff( size_t jointsNumber, size_t axesNumber )
+{
+  SetpointsBuffer buffer = SetpointsBuffer_Create( jointsNumber, axesNumber );
+  TEST_CHECK( buffer != NULL );
+  
+  TEST_CHECK( !SetpointsBuffer_Update( buffer ) );
+  
+  // Only the latest of consecutive publications is taken by the reader
+  for( size_t publicationIndex = 1; publicationIndex <= 3; publicationIndex++ )
+  {
+    DoFVariables** jointsList = SetpointsBuffer_GetJointWriteList( buffer );
+    DoFVariables** axesList = SetpointsBuffer_GetAxisWriteList( buffer );
+    for( size_t jointIndex = 0; jointIndex < jointsNumber; jointIndex++ )
+      jointsList[ jointIndex ]->position = publicationIndex * 10.0 + jointIndex;
+    for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+      axesList[ axisIndex ]->force = -( publicationIndex * 10.0 + axisIndex );
+    SetpointsBuffer_Publish( buffer );
+  }
+  
+  TEST_CHECK( SetpointsBuffer_Update( buffer ) );
+  TEST_CHECK( !SetpointsBuffer_Update( buffer ) );
+  DoFVariables** jointsList = SetpointsBuffer_GetJointReadList( buffer );
+  DoFVariables** axesList = SetpointsBuffer_GetAxisReadList( buffer );
+  for( size_t jointIndex = 0; jointIndex < jointsNumber; jointIndex++ )
+    TEST_CHECK( jointsList[ jointIndex ]->position == 30.0 + jointIndex );
+  for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+    TEST_CHECK( axesList[ axisIndex ]->force == -( 30.0 + axisIndex ) );
+  
+  SetpointsBuffer_Discard( buffer );
+}
+
+int main( void )
+{
+  TestHandoff( 6, 3 );
+  // Plugins without joints or axes
+  TestHandoff( 0, 3 );
+  TestHandoff( 6, 0 );
+  TestHandoff( 0, 0 );
+  
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+#include "shared_variables.h"
+#include "test_check.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define JOINTS_NUMBER 4
+#define AXES_NUMBER 2
+#define CONCURRENT_PUBLICATIONS_NUMBER 200000
+
+// All variables of each publication are set to its index, so that mixed snapshots are detected
+typedef struct PublicationData
+{
+  DoFVariables jointMeasures[ JOINTS_NUMBER ], jointSetpoints[ JOINTS_NUMBER ];
+  DoFVariables axisMeasures[ AXES_NUMBER ], axisSetpoints[ AXES_NUMBER ];
+  DoFVariables* jointMeasuresList[ JOINTS_NUMBER ], * jointSetpointsList[ JOINTS_NUMBER ];
+  DoFVariables* axisMeasuresList[ AXES_NUMBER ], * axisSetpointsList[ AXES_NUMBER ];
+}
+PublicationData;
+
+static void SetVariables( DoFVariables* variables, double value )
+{
+  variables->position = variables->velocity = variables->force = variables->acceleration = value;
+  variables->inertia = variables->stiffness = variables->damping = value;
+}
+
+static bool CheckVariables( const DoFVariables* variables, double value )
+{
+  return ( variables->position == value && variables->velocity == value && variables->force == value && variables->acceleration == value
+           && variables->inertia == value && variables->stiffness == value && variables->damping == value );
+}
+
+static void Publish( SharedVariables variables, PublicationData* publication, uint64_t publicationIndex )
+{
+  double value = (double) publicationIndex;
+  for( size_t jointIndex = 0; jointIndex < JOINTS_NUMBER; jointIndex++ )
+  {
+    SetVariables( &(publication->jointMeasures[ jointIndex ]), value );
+    SetVariables( &(publication->jointSetpoints[ jointIndex ]), value );
+    publication->jointMeasuresList[ jointIndex ] = &(publication->jointMeasures[ jointIndex ]);
+    publication->jointSetpointsList[ jointIndex ] = &(publication->jointSetpoints[ jointIndex ]);
+  }
+  for( size_t axisIndex = 0; axisIndex < AXES_NUMBER; axisIndex++ )
+  {
+    SetVariables( &(publication->axisMeasures[ axisIndex ]), value );
+    SetVariables( &(publication->axisSetpoints[ axisIndex ]), value );
+    publication->axisMeasuresList[ axisIndex ] = &(publication->axisMeasures[ axisIndex ]);
+    publication->axisSetpointsList[ axisIndex ] = &(publication->axisSetpoints[ axisIndex ]);
+  }
+  
+  SharedVariables_Publish( variables, publication->jointMeasuresList, publication->jointSetpointsList, 
+                           publication->axisMeasuresList, publication->axisSetpointsList );
+}
+
+// Reads a consistent snapshot, retrying while publications happen meanwhile, and returns its publication index
+static double ReadSnapshot( SharedVariables variables, uint64_t* retriesCount )
+{
+  double value;
+  bool isConsistent;
+  do
+  {
+    uint64_t sequence = SharedVariables_BeginRead( variables );
+    value = SharedVariables_GetJointMeasures( variables )[ 0 ].position;
+    isConsistent = true;
+    for( size_t jointIndex = 0; jointIndex < JOINTS_NUMBER; jointIndex++ )
+    {
+      isConsistent = CheckVariables( &(SharedVariables_GetJointMeasures( variables )[ jointIndex ]), value ) && isConsistent;
+      isConsistent = CheckVariables( &(SharedVariables_GetJointSetpoints( variables )[ jointIndex ]), value ) && isConsistent;
+    }
+    for( size_t axisIndex = 0; axisIndex < AXES_NUMBER; axisIndex++ )
+    {
+      isConsistent = CheckVariables( &(SharedVariables_GetAxisMeasures( variables )[ axisIndex ]), value ) && isConsistent;
+      isConsistent = CheckVariables( &(SharedVariables_GetAxisSetpoints( variables )[ axisIndex ]), value ) && isConsistent;
+    }
+    if( SharedVariables_EndRead( variables, sequence ) )
+    {
+      // Validated snapshots must never mix publications
+      TEST_CHECK( isConsistent );
+      return value;
+    }
+    (*retriesCount)++;
+  } while( true );
+}
+
+static void TestSegmentLifetime( const char* name )
+{
+  TEST_CHECK( SharedVariables_Open( name ) == NULL );
+  
+  SharedVariables writer = SharedVariables_Create( name, JOINTS_NUMBER, AXES_NUMBER );
+  TEST_CHECK( writer != NULL );
+  // Segments in use are not replaced
+  TEST_CHECK( SharedVariables_Create( name, JOINTS_NUMBER + 1, AXES_NUMBER ) == NULL );
+  
+  SharedVariables reader = SharedVariables_Open( name );
+  TEST_CHECK( reader != NULL );
+  TEST_CHECK( SharedVariables_GetJointsNumber( reader ) == JOINTS_NUMBER && SharedVariables_GetAxesNumber( reader ) == AXES_NUMBER );
+  
+  PublicationData publication;
+  uint64_t retriesCount = 0;
+  Publish( writer, &publication, 1 );
+  TEST_CHECK( ReadSnapshot( reader, &retriesCount ) == 1.0 );
+  // NULL lists keep their last values
+  SetVariables( &(publication.jointMeasures[ 0 ]), 2.0 );
+  SharedVariables_Publish( writer, publication.jointMeasuresList, NULL, NULL, NULL );
+  TEST_CHECK( SharedVariables_GetJointMeasures( reader )[ 0 ].position == 2.0 );
+  TEST_CHECK( CheckVariables( &(SharedVariables_GetAxisSetpoints( reader )[ AXES_NUMBER - 1 ]), 1.0 ) );
+  TEST_CHECK( retriesCount == 0 );
+  
+  // Creator removes the segment name on close, while opened readers keep their mapping
+  SharedVariables_Close( writer );
+  TEST_CHECK( SharedVariables_Open( name ) == NULL );
+  TEST_CHECK( SharedVariables_GetJointMeasures( reader )[ 0 ].position == 2.0 );
+  SharedVariables_Close( reader );
+}
+
+typedef struct WriterData
+{
+  SharedVariables variables;
+  atomic_bool isDone;
+}
+WriterData;
+
+static void* RunWriter( void* data )
+{
+  WriterData* writer = (WriterData*) data;
+  PublicationData publication;
+  
+  for( uint64_t publicationIndex = 1; publicationIndex <= CONCURRENT_PUBLICATIONS_NUMBER; publicationIndex++ )
+    Publish( writer->variables, &publication, publicationIndex );
+  atomic_store( &(writer->isDone), true );
+  
+  return NULL;
+}
+
+// Segment published while being read: every validated snapshot must be whole, and never older than the previous one
+static void TestConcurrentReads( const char* name )
+{
+  WriterData writer = { .variables = SharedVariables_Create( name, JOINTS_NUMBER, AXES_NUMBER ) };
+  TEST_CHECK( writer.variables != NULL );
+  atomic_init( &(writer.isDone), false );
+  SharedVariables reader = SharedVariables_Open( name );
+  TEST_CHECK( reader != NULL );
+  
+  pthread_t writerThread;
+  TEST_CHECK( pthread_create( &writerThread, NULL, RunWriter, &writer ) == 0 );
+  
+  uint64_t readsCount = 0, retriesCount = 0;
+  double lastValue = 0.0;
+  while( !atomic_load( &(writer.isDone) ) )
+  {
+    double value = ReadSnapshot( reader, &retriesCount );
+    TEST_CHECK( value >= lastValue );
+    lastValue = value;
+    readsCount++;
+  }
+  pthread_join( writerThread, NULL );
+  
+  TEST_CHECK( ReadSnapshot( reader, &retriesCount ) == CONCURRENT_PUBLICATIONS_NUMBER );
+  TEST_CHECK( readsCount > 0 );
+  
+  SharedVariables_Close( reader );
+  SharedVariables_Close( writer.variables );
+}
+
+int main( void )
+{
+  // Process specific name, so that concurrent test runs don't share segments
+  char name[ 64 ];
+  snprintf( name, sizeof(name), "/shared_variables_test_%ld", (long) getpid() );
+  
+  TestSegmentLifetime( name );
+  TestConcurrentReads( name );
+  
+  return EXIT_SUCCESS;
+}
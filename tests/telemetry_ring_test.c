@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "telemetry_ring.h"
+#include "test_check.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define JOINTS_NUMBER 4
+#define AXES_NUMBER 2
+#define EXTRA_OUTPUTS_NUMBER 3
+#define CONCURRENT_RECORDS_NUMBER 200000
+
+// All variables of each record are set to its index, so that mixed records are detected
+typedef struct RecordData
+{
+  DoFVariables jointMeasures[ JOINTS_NUMBER ], jointSetpoints[ JOINTS_NUMBER ];
+  DoFVariables axisMeasures[ AXES_NUMBER ], axisSetpoints[ AXES_NUMBER ];
+  DoFVariables* jointMeasuresList[ JOINTS_NUMBER ], * jointSetpointsList[ JOINTS_NUMBER ];
+  DoFVariables* axisMeasuresList[ AXES_NUMBER ], * axisSetpointsList[ AXES_NUMBER ];
+  double extraOutputsList[ EXTRA_OUTPUTS_NUMBER ];
+}
+RecordData;
+
+static void PublishRecord( TelemetryRing ring, RecordData* record, uint64_t recordIndex )
+{
+  double value = (double) recordIndex;
+  for( size_t jointIndex = 0; jointIndex < JOINTS_NUMBER; jointIndex++ )
+  {
+    record->jointMeasures[ jointIndex ].position = record->jointSetpoints[ jointIndex ].velocity = value;
+    record->jointMeasuresList[ jointIndex ] = &(record->jointMeasures[ jointIndex ]);
+    record->jointSetpointsList[ jointIndex ] = &(record->jointSetpoints[ jointIndex ]);
+  }
+  for( size_t axisIndex = 0; axisIndex < AXES_NUMBER; axisIndex++ )
+  {
+    record->axisMeasures[ axisIndex ].force = record->axisSetpoints[ axisIndex ].stiffness = value;
+    record->axisMeasuresList[ axisIndex ] = &(record->axisMeasures[ axisIndex ]);
+    record->axisSetpointsList[ axisIndex ] = &(record->axisSetpoints[ axisIndex ]);
+  }
+  for( size_t outputIndex = 0; outputIndex < EXTRA_OUTPUTS_NUMBER; outputIndex++ )
+    record->extraOutputsList[ outputIndex ] = value;
+  
+  TelemetryRing_Publish( ring, record->jointMeasuresList, record->jointSetpointsList, 
+                         record->axisMeasuresList, record->axisSetpointsList, record->extraOutputsList, value );
+}
+
+static void CheckRecord( TelemetryCursor cursor )
+{
+  double value = (double) TelemetryCursor_GetRecordIndex( cursor );
+  TEST_CHECK( TelemetryCursor_GetTimeDelta( cursor ) == value );
+  for( size_t jointIndex = 0; jointIndex < JOINTS_NUMBER; jointIndex++ )
+  {
+    TEST_CHECK( TelemetryCursor_GetJointMeasures( cursor )[ jointIndex ].position == value );
+    TEST_CHECK( TelemetryCursor_GetJointSetpoints( cursor )[ jointIndex ].velocity == value );
+  }
+  for( size_t axisIndex = 0; axisIndex < AXES_NUMBER; axisIndex++ )
+  {
+    TEST_CHECK( TelemetryCursor_GetAxisMeasures( cursor )[ axisIndex ].force == value );
+    TEST_CHECK( TelemetryCursor_GetAxisSetpoints( cursor )[ axisIndex ].stiffness == value );
+  }
+  for( size_t outputIndex = 0; outputIndex < EXTRA_OUTPUTS_NUMBER; outputIndex++ )
+    TEST_CHECK( TelemetryCursor_GetExtraOutputs( cursor )[ outputIndex ] == value );
+}
+
+static void TestSequentialReads( void )
+{
+  TelemetryRing ring = TelemetryRing_Create( JOINTS_NUMBER, AXES_NUMBER, EXTRA_OUTPUTS_NUMBER, 8 );
+  TEST_CHECK( ring != NULL );
+  TelemetryCursor cursor = TelemetryCursor_Create( ring );
+  TEST_CHECK( cursor != NULL );
+  RecordData record;
+  size_t lostRecordsNumber;
+  
+  TEST_CHECK( !TelemetryCursor_Read( cursor, &lostRecordsNumber ) );
+  
+  for( uint64_t recordIndex = 0; recordIndex < 3; recordIndex++ )
+    PublishRecord( ring, &record, recordIndex );
+  for( uint64_t recordIndex = 0; recordIndex < 3; recordIndex++ )
+  {
+    TEST_CHECK( TelemetryCursor_Read( cursor, &lostRecordsNumber ) && lostRecordsNumber == 0 );
+    TEST_CHECK( TelemetryCursor_GetRecordIndex( cursor ) == recordIndex );
+    CheckRecord( cursor );
+  }
+  // Last read record is kept when there are no new ones
+  TEST_CHECK( !TelemetryCursor_Read( cursor, &lostRecordsNumber ) );
+  TEST_CHECK( TelemetryCursor_GetRecordIndex( cursor ) == 2 );
+  CheckRecord( cursor );
+  
+  // Overrun skips to the oldest record still in the ring
+  for( uint64_t recordIndex = 3; recordIndex < 23; recordIndex++ )
+    PublishRecord( ring, &record, recordIndex );
+  TEST_CHECK( TelemetryCursor_GetPendingRecordsCount( cursor ) == 20 );
+  TEST_CHECK( TelemetryCursor_Read( cursor, &lostRecordsNumber ) && lostRecordsNumber == 12 );
+  TEST_CHECK( TelemetryCursor_GetRecordIndex( cursor ) == 15 );
+  CheckRecord( cursor );
+  TEST_CHECK( TelemetryCursor_GetLostRecordsCount( cursor ) == 12 );
+  
+  TelemetryCursor_Discard( cursor );
+  TelemetryRing_Discard( ring );
+}
+
+typedef struct ProducerData
+{
+  TelemetryRing ring;
+  atomic_bool isDone;
+}
+ProducerData;
+
+static void* RunProducer( void* data )
+{
+  ProducerData* producer = (ProducerData*) data;
+  RecordData record;
+  
+  for( uint64_t recordIndex = 0; recordIndex < CONCURRENT_RECORDS_NUMBER; recordIndex++ )
+    PublishRecord( producer->ring, &record, recordIndex );
+  atomic_store( &(producer->isDone), true );
+  
+  return NULL;
+}
+
+// Small ring overwritten while being read: every read (successful or not) must leave a whole record in the cursor
+static void TestConcurrentReads( void )
+{
+  ProducerData producer = { .ring = TelemetryRing_Create( JOINTS_NUMBER, AXES_NUMBER, EXTRA_OUTPUTS_NUMBER, 2 ) };
+  TEST_CHECK( producer.ring != NULL );
+  atomic_init( &(producer.isDone), false );
+  TelemetryCursor cursor = TelemetryCursor_Create( producer.ring );
+  TEST_CHECK( cursor != NULL );
+  
+  pthread_t producerThread;
+  TEST_CHECK( pthread_create( &producerThread, NULL, RunProducer, &producer ) == 0 );
+  
+  uint64_t readRecordsCount = 0, lostRecordsCount = 0;
+  uint64_t lastRecordIndex = 0;
+  // Records left after producer end are read as well
+  while( !atomic_load( &(producer.isDone) ) || TelemetryCursor_GetPendingRecordsCount( cursor ) > 0 )
+  {
+    size_t lostRecordsNumber;
+    if( TelemetryCursor_Read( cursor, &lostRecordsNumber ) )
+    {
+      TEST_CHECK( readRecordsCount == 0 || TelemetryCursor_GetRecordIndex( cursor ) > lastRecordIndex );
+      lastRecordIndex = TelemetryCursor_GetRecordIndex( cursor );
+      readRecordsCount++;
+    }
+    lostRecordsCount += lostRecordsNumber;
+    if( readRecordsCount > 0 ) CheckRecord( cursor );
+  }
+  pthread_join( producerThread, NULL );
+  
+  TEST_CHECK( lastRecordIndex == CONCURRENT_RECORDS_NUMBER - 1 );
+  TEST_CHECK( readRecordsCount + lostRecordsCount == CONCURRENT_RECORDS_NUMBER );
+  TEST_CHECK( TelemetryCursor_GetLostRecordsCount( cursor ) == lostRecordsCount );
+  
+  TelemetryCursor_Discard( cursor );
+  TelemetryRing_Discard( producer.ring );
+}
+
+int main( void )
+{
+  TestSequentialReads();
+  TestConcurrentReads();
+  
+  return EXIT_SUCCESS;
+}
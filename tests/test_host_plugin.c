@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////////////
+//                                                                                   //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>             //
+//                                                                                   //
+//  This file is part of Robot Control Interface.                                    //
+//                                                                                   //
+//  Robot Control Interface is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published         //
+//  by the Free Software Foundation, either version 3 of the License, or             //
+//  (at your option) any later version.                                              //
+//                                                                                   //
+//  Robot Control Interface is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of                   //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                     //
+//  GNU Lesser General Public License for more details.                              //
+//                                                                                   //
+//  You should have received a copy of the GNU Lesser General Public License         //
+//  along with Robot Control Interface. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                                   //
+///////////////////////////////////////////////////////////////////////////////////////
+
+/// @file test_host_plugin.c
+/// @brief Robot control plugin loaded by plugin_host_test through robot_control_host, misbehaving as requested by its configuration
+
+#define _GNU_SOURCE
+
+#include "robot_control.h"
+
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define JOINTS_NUMBER 2
+#define AXES_NUMBER 1
+
+static const char* JOINT_NAMES_LIST[ JOINTS_NUMBER ] = { "joint_0", "joint_1" };
+static const char* AXIS_NAMES_LIST[ AXES_NUMBER ] = { "axis_0" };
+
+// Configuration strings: "hang_init", "hang_step", "crash_step", "slow_step", or any other for normal behavior
+static char mode[ 32 ];
+static double extraInput;
+
+static void Hang( void )
+{
+  while( true ) pause();
+}
+
+bool InitController( const char* configuration )
+{
+  strncpy( mode, configuration, sizeof(mode) - 1 );
+  if( strcmp( mode, "hang_init" ) == 0 ) Hang();
+  
+  return true;
+}
+
+void EndController( void ) { }
+
+size_t GetJointsNumber( void ) { return JOINTS_NUMBER; }
+
+const char** GetJointNamesList( void ) { return JOINT_NAMES_LIST; }
+
+size_t GetAxesNumber( void ) { return AXES_NUMBER; }
+
+const char** GetAxisNamesList( void ) { return AXIS_NAMES_LIST; }
+
+void SetControlState( enum ControlState controlState ) { (void) controlState; }
+
+void RunControlStep( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, 
+                     DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+{
+  if( strcmp( mode, "hang_step" ) == 0 ) Hang();
+  if( strcmp( mode, "crash_step" ) == 0 ) raise( SIGSEGV );
+  if( strcmp( mode, "slow_step" ) == 0 ) 
+  {
+    struct timespec stepTime = { .tv_sec = 0, .tv_nsec = 5000000 };
+    nanosleep( &stepTime, NULL );
+  }
+  
+  for( size_t jointIndex = 0; jointIndex < JOINTS_NUMBER; jointIndex++ )
+    jointSetpointsList[ jointIndex ]->position = 2.0 * jointMeasuresList[ jointIndex ]->position + timeDelta;
+  for( size_t axisIndex = 0; axisIndex < AXES_NUMBER; axisIndex++ )
+    axisSetpointsList[ axisIndex ]->force = -axisMeasuresList[ axisIndex ]->force;
+}
+
+size_t GetExtraInputsNumber( void ) { return 1; }
+
+void SetExtraInputsList( double* inputsList ) { extraInput = inputsList[ 0 ]; }
+
+size_t GetExtraOutputsNumber( void ) { return 1; }
+
+void GetExtraOutputsList( double* outputsList ) { outputsList[ 0 ] = 3.0 * extraInput; }